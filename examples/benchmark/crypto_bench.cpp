@@ -0,0 +1,122 @@
+#include <../src/EspCipher.h>
+#include <Arduino.h>
+
+// Benchmark: legacy AES-ECB password format vs. AES-GCM secret envelope
+// build with: pio run -e esp32_bench_crypto -t upload -t monitor
+
+static const unsigned char key[16] = {'s', 'e', 'c', 'u', 'r', 'e', '_', 'k', 'e', 'y', '_', 'd', 'y', 'n', 'a', 'm'};
+static const int ITERATIONS = 1000;
+static const int BOOT_SECRETS = 20;
+
+static char plain[129];
+static char encrypted[256];
+static char decrypted[129];
+
+static void report(const char *name, uint32_t durationUs, size_t bytes) {
+  float usPerOp = (float)durationUs / ITERATIONS;
+  float kBytesPerSec = usPerOp > 0 ? (bytes / 1024.0f) / (usPerOp / 1000000.0f) : 0;
+  Serial.printf("%-34s %8.2f us/op %8.1f kB/s\n", name, usPerOp, kBytesPerSec);
+}
+
+static bool check(bool ok, const char *what) {
+  if (!ok)
+    Serial.printf("FAILED: %s\n", what);
+  return ok;
+}
+
+#define BENCH(name, bytes, code)                                                                                                                     \
+  do {                                                                                                                                               \
+    uint32_t start = micros();                                                                                                                       \
+    for (int i = 0; i < ITERATIONS; i++) {                                                                                                           \
+      code;                                                                                                                                          \
+    }                                                                                                                                                \
+    report(name, micros() - start, bytes);                                                                                                           \
+  } while (0)
+
+static void runSize(size_t len) {
+  memset(plain, 'x', len);
+  plain[len] = '\0';
+  EspCipher cipher(key);
+
+  Serial.printf("\n--- plaintext length: %u bytes ---\n", (unsigned)len);
+  // every measured path must succeed, otherwise the numbers are meaningless
+  bool legacy = true;
+  if (!check(EspStrUtil::encryptPassword(plain, key, encrypted, sizeof(encrypted)), "encryptPassword()") ||
+      !check(EspStrUtil::decryptPassword(encrypted, key, decrypted, sizeof(decrypted)) && strcmp(decrypted, plain) == 0,
+             "decryptPassword()") ||
+      !check(EspStrUtil::encryptSecret(plain, key, encrypted, sizeof(encrypted)), "encryptSecret()") ||
+      !check(EspStrUtil::decryptSecret(encrypted, key, decrypted, sizeof(decrypted), &legacy) && !legacy &&
+                 strcmp(decrypted, plain) == 0,
+             "decryptSecret()")) {
+    return;
+  }
+  BENCH("ECB encryptPassword()", len, EspStrUtil::encryptPassword(plain, key, encrypted, sizeof(encrypted)));
+  BENCH("ECB decryptPassword()", len, EspStrUtil::decryptPassword(encrypted, key, decrypted, sizeof(decrypted)));
+  BENCH("ECB EspCipher::encrypt()", len, cipher.encrypt(plain, encrypted, sizeof(encrypted)));
+  BENCH("ECB EspCipher::decrypt()", len, cipher.decrypt(encrypted, decrypted, sizeof(decrypted)));
+  BENCH("GCM encryptSecret()", len, EspStrUtil::encryptSecret(plain, key, encrypted, sizeof(encrypted)));
+  BENCH("GCM decryptSecret()", len, EspStrUtil::decryptSecret(encrypted, key, decrypted, sizeof(decrypted)));
+  BENCH("GCM EspCipher::encryptSecret()", len, cipher.encryptSecret(plain, encrypted, sizeof(encrypted)));
+  BENCH("GCM EspCipher::decryptSecret()", len, cipher.decryptSecret(encrypted, decrypted, sizeof(decrypted)));
+}
+
+static void runBootPath() {
+  static char secrets[BOOT_SECRETS][EspStrUtil::secretEncodedSize(32)];
+  static char outputs[BOOT_SECRETS][33];
+  EspCipherJob jobs[BOOT_SECRETS] = {};
+  EspCipher cipher(key);
+
+  Serial.printf("\n--- boot path: decrypt %d secrets of 32 bytes ---\n", BOOT_SECRETS);
+  memset(plain, 'x', 32);
+  plain[32] = '\0';
+
+  for (int i = 0; i < BOOT_SECRETS; i++) {
+    if (!check(EspStrUtil::encryptPassword(plain, key, secrets[i], sizeof(secrets[i])), "encryptPassword()"))
+      return;
+  }
+  bool ok = true;
+  uint32_t start = micros();
+  for (int i = 0; i < BOOT_SECRETS; i++) {
+    ok &= EspStrUtil::decryptPassword(secrets[i], key, outputs[i], sizeof(outputs[i]));
+  }
+  uint32_t ecbDuration = micros() - start;
+  for (int i = 0; i < BOOT_SECRETS; i++) {
+    ok &= strcmp(outputs[i], plain) == 0;
+  }
+  if (check(ok, "ECB decryptPassword() loop"))
+    Serial.printf("%-34s %8u us\n", "ECB decryptPassword() loop", (unsigned)ecbDuration);
+
+  for (int i = 0; i < BOOT_SECRETS; i++) {
+    if (!check(cipher.encryptSecret(plain, secrets[i], sizeof(secrets[i])), "EspCipher::encryptSecret()"))
+      return;
+    outputs[i][0] = '\0';
+    jobs[i] = {secrets[i], outputs[i], sizeof(outputs[i]), false, true};
+  }
+  start = micros();
+  cipher.setKey(key);
+  size_t done = cipher.decryptSecretBatch(jobs, BOOT_SECRETS);
+  uint32_t duration = micros() - start;
+  ok = done == BOOT_SECRETS;
+  for (int i = 0; i < BOOT_SECRETS; i++) {
+    ok &= jobs[i].ok && !jobs[i].legacy && strcmp(outputs[i], plain) == 0; // really GCM, not the legacy fallback
+  }
+  if (check(ok, "GCM EspCipher setKey + batch")) {
+    Serial.printf("%-34s %8u us\n", "GCM EspCipher setKey + batch", (unsigned)duration);
+    // > 1.00: the authenticated format costs boot time compared to ECB
+    Serial.printf("%-34s %8.2f x\n", "GCM / ECB boot time", ecbDuration ? (double)duration / ecbDuration : 0.0);
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("EspStrUtil crypto benchmark");
+  runSize(16);
+  runSize(32);
+  runSize(128);
+  runBootPath();
+}
+
+void loop() {
+  // nothing to do
+}
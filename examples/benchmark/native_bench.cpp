@@ -0,0 +1,127 @@
+#include <../src/EspCbor.h>
+#include <../src/EspCipher.h>
+#include <../src/EspStrUtil.h>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+// Host benchmark of the EspStrUtil hot paths, prints ns/op and bytes/op
+// build with: pio run -e native && .pio/build/native/program
+// compare the output of two commits to catch performance regressions
+
+static const unsigned char key[16] = {'s', 'e', 'c', 'u', 'r', 'e', '_', 'k', 'e', 'y', '_', 'd', 'y', 'n', 'a', 'm'};
+
+static char buf[256];
+static char encrypted[256];
+static char decrypted[129];
+static volatile size_t sink; // keeps results alive for the optimizer
+
+static void report(const char *name, double durationNs, long iterations, size_t bytes) {
+  printf("%-34s %10.1f ns/op %6.1f bytes/op\n", name, durationNs / iterations, (double)bytes / iterations);
+}
+
+// code: expression that calls the function and yields the bytes it wrote
+// (or read, for hashes and parsers), summed over the loop for bytes/op
+#define BENCH(name, iterations, code)                                                                                                                \
+  do {                                                                                                                                               \
+    size_t bytes = 0;                                                                                                                                \
+    auto start = std::chrono::steady_clock::now();                                                                                                   \
+    for (long i = 0; i < (iterations); i++) {                                                                                                        \
+      bytes += (size_t)(code);                                                                                                                       \
+    }                                                                                                                                                \
+    std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;                                                   \
+    sink += bytes;                                                                                                                                   \
+    report(name, duration.count(), iterations, bytes);                                                                                               \
+  } while (0)
+
+// bytes written to buf, 0 on error
+static inline size_t written(const char *end) { return end ? (size_t)(end - buf) : 0; }
+
+// bytes of a string result, 0 on error
+static inline size_t written(bool ok, const char *output) { return ok ? strlen(output) : 0; }
+
+static void benchFormatting() {
+  printf("\n--- formatting ---\n");
+  BENCH("intToString(int32)", 1000000, strlen(EspStrUtil::intToString((int32_t)-123456789 + (int32_t)i)));
+  BENCH("toChars(uint64)", 1000000, written(EspStrUtil::toChars(buf, sizeof(buf), 18446744073709551615ull - i)));
+  BENCH("floatToString(1)", 1000000, strlen(EspStrUtil::floatToString(21.5f + i * 0.01f)));
+  BENCH("floatToChars(3)", 1000000, written(EspStrUtil::floatToChars(buf, sizeof(buf), 12345.678 + i, 3)));
+  BENCH("formatBytes()", 1000000, strlen(EspStrUtil::formatBytes(123456 + i)));
+  BENCH("formatSize(SI)", 1000000, written(EspStrUtil::formatSize(buf, sizeof(buf), 123456 + i, 2, true)));
+  BENCH("formatDuration()", 1000000, written(EspStrUtil::formatDuration(buf, sizeof(buf), 273127 + i)));
+  BENCH("formatRate()", 1000000, written(EspStrUtil::formatRate(buf, sizeof(buf), 15000 + i, 10000)));
+}
+
+static void benchDateTime() {
+  printf("\n--- date/time ---\n");
+  BENCH("getDateTimeString()", 1000000, strlen(EspStrUtil::getDateTimeString()));
+  BENCH("getTimeString()", 1000000, strlen(EspStrUtil::getTimeString()));
+  BENCH("getIsoTimeString(millis)", 1000000, written(EspStrUtil::getIsoTimeString(buf, sizeof(buf), true)));
+}
+
+static void benchHash() {
+  static const char topic[] = "home/boiler/heating_circuit_1/flow_temperature";
+  const size_t len = sizeof(topic) - 1;
+  printf("\n--- hashing (%u bytes) ---\n", (unsigned)len);
+  BENCH("hash32()", 1000000, (sink += EspStrUtil::hash32(topic), len));
+  BENCH("fnv1a32()", 1000000, (sink += EspStrUtil::fnv1a32(topic), len));
+  BENCH("fnv1a64()", 1000000, (sink += (size_t)EspStrUtil::fnv1a64(topic), len));
+  BENCH("strHash()", 1000000, (sink += EspStrUtil::strHash(topic), len));
+}
+
+static void benchTransform() {
+  static const char name[] = "Boiler Heating Circuit 1 Flow Temperature";
+  static const char integer[] = "-12345";
+  static const char decimal[] = "-12.345";
+  const size_t len = sizeof(name) - 1;
+  printf("\n--- string transforms (%u bytes) ---\n", (unsigned)len);
+  BENCH("to_lowercase()", 1000000, EspStrUtil::to_lowercase(name, buf, sizeof(buf)));
+  BENCH("replace_whitespace()", 1000000, EspStrUtil::replace_whitespace(name, buf, sizeof(buf)));
+  BENCH("slugify()", 1000000, EspStrUtil::slugify(name, buf, sizeof(buf)));
+  BENCH("isNumber()", 1000000, EspStrUtil::isNumber(integer) ? sizeof(integer) - 1 : 0);
+  int32_t value = 0;
+  BENCH("parseInt(int32)", 1000000, EspStrUtil::parseInt(integer, value) ? sizeof(integer) - 1 : 0);
+  double number = 0;
+  BENCH("parseFloat(double)", 1000000, EspStrUtil::parseFloat(decimal, number) ? sizeof(decimal) - 1 : 0);
+  sink += value + (size_t)number;
+}
+
+static void benchCbor() {
+  uint8_t cbor[64];
+  size_t len = 0;
+  printf("\n--- CBOR telemetry {temp, on, rssi} ---\n");
+  BENCH("EspCborWriter", 1000000, [&] {
+    EspCborWriter w(cbor, sizeof(cbor));
+    w.beginMap(3).add("temp", 21.5f + (i & 7)).add("on", true).add("rssi", -67);
+    return len = w.length();
+  }());
+  BENCH("EspCborReader::toText()", 1000000, written(EspCborReader::toText(buf, sizeof(buf), cbor, len)));
+}
+
+static void benchCrypto(size_t len) {
+  char plain[129];
+  memset(plain, 'x', len);
+  plain[len] = '\0';
+  EspCipher cipher(key);
+
+  printf("\n--- crypto (plaintext %u bytes) ---\n", (unsigned)len);
+  BENCH("encryptPassword()", 20000, written(EspStrUtil::encryptPassword(plain, key, encrypted, sizeof(encrypted)), encrypted));
+  BENCH("decryptPassword()", 20000, written(EspStrUtil::decryptPassword(encrypted, key, decrypted, sizeof(decrypted)), decrypted));
+  BENCH("EspCipher::encrypt()", 20000, written(cipher.encrypt(plain, encrypted, sizeof(encrypted)), encrypted));
+  BENCH("EspCipher::decrypt()", 20000, written(cipher.decrypt(encrypted, decrypted, sizeof(decrypted)), decrypted));
+  BENCH("encryptSecret()", 20000, written(EspStrUtil::encryptSecret(plain, key, encrypted, sizeof(encrypted)), encrypted));
+  BENCH("decryptSecret()", 20000, written(EspStrUtil::decryptSecret(encrypted, key, decrypted, sizeof(decrypted)), decrypted));
+  BENCH("base64Encode()", 200000, written(EspStrUtil::base64Encode(buf, sizeof(buf), plain, len)));
+}
+
+int main() {
+  printf("EspStrUtil native benchmark\n");
+  benchFormatting();
+  benchDateTime();
+  benchHash();
+  benchTransform();
+  benchCbor();
+  benchCrypto(16);
+  benchCrypto(128);
+  return 0;
+}
@@ -0,0 +1,7 @@
+# PlatformIO pre-script of the fuzz envs: libFuzzer needs clang, and the
+# sanitizers must also be given to the linker
+Import("env")
+
+env.Replace(CC="clang", CXX="clang++", LINK="clang++")
+sanitizers = ["-fsanitize=fuzzer,address,undefined"]
+env.Append(CCFLAGS=sanitizers, LINKFLAGS=sanitizers)
@@ -0,0 +1,46 @@
+#include <../src/EspStrUtil.h>
+#include <stdlib.h>
+
+// libFuzzer target: base64Decode() / base64Encode() incl. in-place decoding
+// build with: pio run -e fuzz_base64 && .pio/build/fuzz_base64/program -max_total_time=60
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  static uint8_t decoded[4096];
+  static uint8_t again[4096];
+  static char encoded[8192];
+  static char inPlace[4096];
+  if (size > sizeof(inPlace))
+    return 0;
+  const char *src = (const char *)data;
+
+  // decode any input, a successful result must encode and decode to the same bytes
+  size_t n = 0;
+  if (EspStrUtil::base64Decode(decoded, sizeof(decoded), src, size, &n)) {
+    if (n > EspStrUtil::base64DecodedSize(size))
+      abort();
+    size_t m = 0;
+    if (EspStrUtil::base64Encode(encoded, sizeof(encoded), decoded, n) == NULL ||
+        !EspStrUtil::base64Decode(again, sizeof(again), encoded, strlen(encoded), &m) || m != n ||
+        memcmp(again, decoded, n) != 0)
+      abort();
+
+    // in place must give the same result
+    memcpy(inPlace, src, size);
+    if (!EspStrUtil::base64Decode(inPlace, sizeof(inPlace), inPlace, size, &m) || m != n ||
+        memcmp(inPlace, decoded, n) != 0)
+      abort();
+  }
+  // short output buffers must be detected
+  EspStrUtil::base64Decode(decoded, size % 7, src, size, &n);
+
+  // encode the input as binary, both alphabets must decode to the input
+  for (int urlSafe = 0; urlSafe < 2; urlSafe++) {
+    char *end = EspStrUtil::base64Encode(encoded, sizeof(encoded), data, size, urlSafe);
+    if (end == NULL || (size_t)(end - encoded) + 1 > EspStrUtil::base64EncodedSize(size, !urlSafe))
+      abort();
+    if (!EspStrUtil::base64Decode(decoded, sizeof(decoded), encoded, end - encoded, &n) || n != size ||
+        memcmp(decoded, data, size) != 0)
+      abort();
+  }
+  return 0;
+}
@@ -0,0 +1,46 @@
+#include <../src/EspCipher.h>
+#include <../src/EspStrUtil.h>
+#include <stdlib.h>
+
+// libFuzzer target: decryptPassword() / decryptSecret() incl. removePadding()
+// build with: pio run -e fuzz_decrypt && .pio/build/fuzz_decrypt/program -max_total_time=60
+
+static const unsigned char key[16] = {'s', 'e', 'c', 'u', 'r', 'e', '_', 'k', 'e', 'y', '_', 'd', 'y', 'n', 'a', 'm'};
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  static EspCipher cipher(key);
+  char input[512];
+  char output[160];
+  char encrypted[256];
+  char decrypted[160];
+  bool legacy = false;
+
+  // 1. the fuzz input as Base64 text
+  size_t len = size < sizeof(input) - 1 ? size : sizeof(input) - 1;
+  memcpy(input, data, len);
+  input[len] = '\0';
+  EspStrUtil::decryptPassword(input, key, output, sizeof(output));
+  EspStrUtil::decryptSecret(input, key, output, sizeof(output), &legacy);
+  cipher.decrypt(input, output, sizeof(output));
+  cipher.decryptSecret(input, output, sizeof(output), &legacy);
+
+  // 2. the fuzz input as ciphertext, reaches the padding check with any block content
+  if (EspStrUtil::base64Encode(input, sizeof(input), data, size < 300 ? size : 300) != NULL) {
+    EspStrUtil::decryptPassword(input, key, output, 1 + (size % sizeof(output)));
+    EspStrUtil::decryptSecret(input, key, output, 1 + (size % sizeof(output)), &legacy);
+  }
+
+  // 3. round trip of the fuzz input as plaintext
+  if (len > 0 && len <= 128 && memchr(data, '\0', len) == NULL) {
+    memcpy(input, data, len);
+    input[len] = '\0';
+    if (!EspStrUtil::encryptPassword(input, key, encrypted, sizeof(encrypted)) ||
+        !EspStrUtil::decryptPassword(encrypted, key, decrypted, sizeof(decrypted)) || strcmp(decrypted, input) != 0)
+      abort();
+    if (!EspStrUtil::encryptSecret(input, key, encrypted, sizeof(encrypted)) ||
+        !EspStrUtil::decryptSecret(encrypted, key, decrypted, sizeof(decrypted), &legacy) || legacy ||
+        strcmp(decrypted, input) != 0)
+      abort();
+  }
+  return 0;
+}
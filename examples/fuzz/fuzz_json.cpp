@@ -0,0 +1,37 @@
+#include <../src/EspTokenizer.h>
+#include <stdlib.h>
+
+// libFuzzer target: EspJsonReader and EspKvReader
+// build with: pio run -e fuzz_json && .pio/build/fuzz_json/program -max_total_time=60
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  const char *text = (const char *)data;
+  char value[64];
+
+  // read all tokens, every token must be a view into the input
+  EspJsonReader json(text, size);
+  for (size_t i = 0; i <= size + 1; i++) {
+    EspJsonToken t = json.next();
+    EspStrView v = json.text();
+    if (v.len > 0 && (v.data < text || v.data + v.len > text + size))
+      abort();
+    if (t == EspJsonToken::End || t == EspJsonToken::Error)
+      break;
+    if (t == EspJsonToken::String || t == EspJsonToken::Key)
+      json.copyTo(value, 1 + (i % sizeof(value)));
+    double d;
+    json.asFloat(d);
+  }
+
+  // search and skip
+  EspJsonReader search(text, size);
+  if (search.next() == EspJsonToken::BeginObject && search.findKey("a"))
+    search.skip();
+
+  EspKvReader kv(text, size);
+  for (size_t i = 0; i <= size && kv.next(); i++) {
+    int32_t n;
+    kv.asInt(n);
+  }
+  return 0;
+}
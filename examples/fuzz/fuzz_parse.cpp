@@ -0,0 +1,61 @@
+#include <../src/EspStrUtil.h>
+#include <stdlib.h>
+
+// libFuzzer target: parseInt() / parseFloat() / parseBool()
+// build with: pio run -e fuzz_parse && .pio/build/fuzz_parse/program -max_total_time=60
+
+template <typename T>
+static void parseInt(const char *first, const char *last, int base) {
+  T value = 0;
+  EspParseResult r = EspStrUtil::parseInt(first, last, value, base);
+  if (r.ptr < first || r.ptr > last)
+    abort();
+  if (r && base == 10 && r.ptr > first) {
+    // a decimal result must format back to the same number
+    char buf[32];
+    char *end = EspStrUtil::toChars(buf, sizeof(buf), value);
+    T back = 0;
+    if (end == NULL || !EspStrUtil::parseInt(buf, end, back, 10) || back != value)
+      abort();
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (size == 0)
+    return 0;
+  // first byte selects the base, the rest is the text
+  int base = data[0] % 38;
+  if (base == 1)
+    base = 10;
+  const char *first = (const char *)data + 1;
+  const char *last = (const char *)data + size;
+
+  parseInt<int8_t>(first, last, base);
+  parseInt<uint16_t>(first, last, base);
+  parseInt<int32_t>(first, last, base);
+  parseInt<uint64_t>(first, last, base);
+  parseInt<int64_t>(first, last, base);
+
+  double d = 0;
+  EspParseResult r = EspStrUtil::parseFloat(first, last, d);
+  if (r.ptr < first || r.ptr > last)
+    abort();
+  if (r && (size_t)(r.ptr - first) < 40) {
+    // must be the same double as strtod() of the parsed text
+    char buf[64];
+    memcpy(buf, first, r.ptr - first);
+    buf[r.ptr - first] = '\0';
+    if (strtod(buf, NULL) != d)
+      abort();
+  }
+  float f = 0;
+  r = EspStrUtil::parseFloat(first, last, f);
+  if (r.ptr < first || r.ptr > last)
+    abort();
+
+  bool b = false;
+  r = EspStrUtil::parseBool(first, last, b);
+  if (r.ptr < first || r.ptr > last)
+    abort();
+  return 0;
+}
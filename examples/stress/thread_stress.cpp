@@ -0,0 +1,60 @@
+#include <../src/EspStrUtil.h>
+#include <atomic>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+// Host stress test of the static-buffer API: many threads call intToString(),
+// floatToString(), formatBytes() and getTimeString() at the same time and
+// compare every result with a private snprintf() reference.
+// build with: pio run -e native_stress && .pio/build/native_stress/program
+// the default build shows corrupted results, -DESP_STR_UTIL_THREAD_SAFE none
+
+static const int THREADS = 16;
+static const long ITERATIONS = 200000;
+
+static std::atomic<long> corrupted(0);
+
+static void worker(int id) {
+  char expected[64];
+  for (long i = 0; i < ITERATIONS; i++) {
+    int32_t value = (int32_t)(id * 1000003 + i);
+    // four results alive at the same time, needs ESP_STR_UTIL_RING_SLOTS >= 4
+    const char *a = EspStrUtil::intToString(value);
+    const char *b = EspStrUtil::floatToString(value * 0.5, 1);
+    const char *c = EspStrUtil::intToString(-value);
+    const char *t = EspStrUtil::getTimeString();
+
+    snprintf(expected, sizeof(expected), "%d", (int)value);
+    corrupted += strcmp(a, expected) != 0;
+    snprintf(expected, sizeof(expected), "%.1f", value * 0.5);
+    corrupted += strcmp(b, expected) != 0;
+    snprintf(expected, sizeof(expected), "%d", (int)-value);
+    corrupted += strcmp(c, expected) != 0;
+    corrupted += strlen(t) != 8;
+
+    const char *bytes = EspStrUtil::formatBytes((unsigned long long)value);
+    corrupted += bytes[0] < '0' || bytes[0] > '9';
+  }
+}
+
+int main() {
+#if defined(ESP_STR_UTIL_THREAD_SAFE)
+  printf("thread-safe mode, %d ring slots\n", ESP_STR_UTIL_RING_SLOTS);
+#else
+  printf("default mode (shared static buffers)\n");
+#endif
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREADS; i++) {
+    threads.emplace_back(worker, i);
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  printf("%d threads x %ld iterations: %ld corrupted results\n", THREADS, ITERATIONS, corrupted.load());
+#if defined(ESP_STR_UTIL_THREAD_SAFE)
+  return corrupted == 0 ? 0 : 1;
+#else
+  return 0;
+#endif
+}
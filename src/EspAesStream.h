@@ -0,0 +1,327 @@
+#pragma once
+
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   format of the EspAesEncryptor / EspAesDecryptor stream
+ *          Base64 of: header | chunk | chunk | ... | last chunk
+ *          header: version byte and 8 random bytes (nonce prefix)
+ *          chunk:  AES-128-GCM ciphertext of 128 plaintext bytes + tag,
+ *                  the last chunk has 0..127 plaintext bytes
+ *          nonce of chunk n: nonce prefix | n (big endian), the high
+ *          bit marks the last chunk, so chunks can not be reordered,
+ *          dropped or cut off unnoticed. The header is authenticated
+ *          as additional data of every chunk.
+ * *******************************************************************/
+struct EspAesStreamFormat {
+  static constexpr uint8_t VERSION = 1;
+  static constexpr size_t PREFIX_SIZE = 8;
+  static constexpr size_t HEADER_SIZE = 1 + PREFIX_SIZE;
+  static constexpr size_t NONCE_SIZE = 12;
+  static constexpr size_t TAG_SIZE = 16;
+  static constexpr size_t CHUNK_SIZE = 128;                  // plaintext bytes per chunk
+  static constexpr size_t SEALED_SIZE = CHUNK_SIZE + TAG_SIZE; // 144 bytes = 192 Base64 chars
+  static constexpr uint32_t LAST_CHUNK = 0x80000000u;
+
+  /**
+   * *******************************************************************
+   * @brief   number of Base64 chars of an encrypted stream
+   * @param   len   length of the plaintext
+   * @return  number of chars passed to the sink (without '\0')
+   * *******************************************************************/
+  static constexpr size_t encodedSize(size_t len) {
+    return HEADER_SIZE / 3 * 4 + len / CHUNK_SIZE * (SEALED_SIZE / 3 * 4) +
+           EspStrUtil::base64EncodedSize(len % CHUNK_SIZE + TAG_SIZE) - 1;
+  }
+
+  // nonce prefix | chunk counter, high bit set for the last chunk
+  static void nonce(unsigned char *out, const unsigned char *header, uint32_t counter, bool last) {
+    memcpy(out, header + 1, PREFIX_SIZE);
+    if (last)
+      counter |= LAST_CHUNK;
+    out[8] = (unsigned char)(counter >> 24);
+    out[9] = (unsigned char)(counter >> 16);
+    out[10] = (unsigned char)(counter >> 8);
+    out[11] = (unsigned char)counter;
+  }
+
+  static_assert(HEADER_SIZE % 3 == 0 && SEALED_SIZE % 3 == 0, "chunks must end on a Base64 group");
+};
+
+/**
+ * *******************************************************************
+ * @brief   streaming authenticated encryption (AES-128-GCM)
+ *          encrypts any length of data chunk by chunk and writes the
+ *          Base64 output to a sink, memory usage is constant.
+ *          Every stream gets a random nonce, equal data gives different
+ *          output. See EspAesStreamFormat for the format.
+ * *******************************************************************/
+class EspAesEncryptor {
+
+private:
+  using Format = EspAesStreamFormat;
+
+  mbedtls_gcm_context gcm;
+  EspStreamSink sink = NULL;
+  void *sinkCtx = NULL;
+  unsigned char header[Format::HEADER_SIZE];
+  unsigned char plain[Format::CHUNK_SIZE];
+  size_t plainLen = 0;
+  uint32_t counter = 0;
+  bool active = false;
+
+  // encrypt the pending plaintext as the next chunk and pass it to the sink
+  bool seal(bool last) {
+    if (counter >= Format::LAST_CHUNK)
+      return false; // stream to long
+    unsigned char nonce[Format::NONCE_SIZE];
+    unsigned char sealed[Format::SEALED_SIZE];
+    char base64[Format::SEALED_SIZE / 3 * 4 + 1];
+    EspStrUtil::ZeroizeOnExit wipeSealed(sealed, sizeof(sealed));
+    Format::nonce(nonce, header, counter++, last);
+    if (mbedtls_gcm_crypt_and_tag(&gcm, MBEDTLS_GCM_ENCRYPT, plainLen, nonce, sizeof(nonce), header,
+                                  sizeof(header), plain, sealed, Format::TAG_SIZE, sealed + plainLen) != 0) {
+      return false;
+    }
+    char *end = EspStrUtil::base64Encode(base64, sizeof(base64), sealed, plainLen + Format::TAG_SIZE);
+    plainLen = 0;
+    return end != NULL && sink(base64, end - base64, sinkCtx);
+  }
+
+  void wipe() {
+    EspStrUtil::secureZero(plain, sizeof(plain));
+    plainLen = 0;
+    counter = 0;
+    active = false;
+  }
+
+public:
+  EspAesEncryptor() { mbedtls_gcm_init(&gcm); }
+  ~EspAesEncryptor() {
+    wipe();
+    mbedtls_gcm_free(&gcm);
+  }
+  EspAesEncryptor(const EspAesEncryptor &) = delete;
+  EspAesEncryptor &operator=(const EspAesEncryptor &) = delete;
+
+  /**
+   * *******************************************************************
+   * @brief   start a new encryption stream and write its header
+   * @param   key   16-byte AES key used for encryption
+   * @param   sink  callback that receives the Base64 output
+   * @param   ctx   user context pointer passed to the sink
+   * @return  true if the stream is ready
+   * *******************************************************************/
+  bool init(const unsigned char *key, EspStreamSink sink, void *ctx = NULL) {
+    wipe();
+    if (!key || !sink)
+      return false;
+    if (mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, 128) != 0)
+      return false;
+    this->sink = sink;
+    sinkCtx = ctx;
+    header[0] = Format::VERSION;
+    EspStrUtil::fillRandom(header + 1, Format::PREFIX_SIZE);
+    char base64[Format::HEADER_SIZE / 3 * 4 + 1];
+    char *end = EspStrUtil::base64Encode(base64, sizeof(base64), header, sizeof(header));
+    active = end != NULL && sink(base64, end - base64, ctx);
+    return active;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   encrypt the next chunk of data
+   * @param   data  plaintext chunk
+   * @param   len   length of plaintext chunk
+   * @return  true if successful, false on error or if sink aborted
+   * *******************************************************************/
+  bool update(const void *data, size_t len) {
+    if (!active || (!data && len > 0))
+      return false;
+    const unsigned char *p = (const unsigned char *)data;
+    while (len > 0) {
+      size_t n = Format::CHUNK_SIZE - plainLen;
+      if (n > len)
+        n = len;
+      memcpy(plain + plainLen, p, n);
+      plainLen += n;
+      p += n;
+      len -= n;
+      // a full chunk is never the last one, finish() always adds one
+      if (plainLen == Format::CHUNK_SIZE && !seal(false)) {
+        wipe();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   write the last chunk (0..127 bytes) and end the stream
+   * @return  true if successful, false on error or if sink aborted
+   * *******************************************************************/
+  bool finish() {
+    bool ok = active && seal(true);
+    wipe();
+    return ok;
+  }
+};
+
+/**
+ * *******************************************************************
+ * @brief   streaming decryption of the EspAesEncryptor output
+ *          accepts the Base64 input in chunks of any size, verifies
+ *          every chunk and writes its plaintext to a sink, memory usage
+ *          is constant.
+ *          Plaintext passed to the sink before finish() returned true
+ *          is unverified: each chunk is authentic, but the stream may
+ *          still turn out to be cut off or corrupt later. Buffer it or
+ *          be ready to discard it if finish() (or update()) fails.
+ * *******************************************************************/
+class EspAesDecryptor {
+
+private:
+  using Format = EspAesStreamFormat;
+  static constexpr size_t IN_CHARS = 64; // decoded in groups of 64 Base64 chars = 48 bytes
+
+  mbedtls_gcm_context gcm;
+  EspStreamSink sink = NULL;
+  void *sinkCtx = NULL;
+  char base64[IN_CHARS];
+  unsigned char header[Format::HEADER_SIZE];
+  unsigned char sealed[Format::SEALED_SIZE];
+  size_t base64Len = 0;
+  size_t headerLen = 0;
+  size_t sealedLen = 0;
+  uint32_t counter = 0;
+  bool active = false;
+
+  // verify and decrypt the collected chunk and pass it to the sink
+  bool open(bool last) {
+    if (sealedLen < Format::TAG_SIZE || counter >= Format::LAST_CHUNK)
+      return false; // chunk to short or stream to long
+    size_t len = sealedLen - Format::TAG_SIZE;
+    unsigned char nonce[Format::NONCE_SIZE];
+    unsigned char plain[Format::CHUNK_SIZE];
+    EspStrUtil::ZeroizeOnExit wipePlain(plain, sizeof(plain));
+    Format::nonce(nonce, header, counter++, last);
+    sealedLen = 0;
+    if (mbedtls_gcm_auth_decrypt(&gcm, len, nonce, sizeof(nonce), header, sizeof(header), sealed + len,
+                                 Format::TAG_SIZE, sealed, plain) != 0) {
+      return false; // authentication failed
+    }
+    return len == 0 || sink((const char *)plain, len, sinkCtx);
+  }
+
+  // split decoded bytes into header and chunks, a full chunk is never the last one
+  bool consume(const unsigned char *data, size_t len) {
+    while (len > 0) {
+      if (headerLen < Format::HEADER_SIZE) {
+        header[headerLen++] = *data++;
+        len--;
+        if (headerLen == Format::HEADER_SIZE && header[0] != Format::VERSION)
+          return false; // unknown version
+        continue;
+      }
+      size_t n = Format::SEALED_SIZE - sealedLen;
+      if (n > len)
+        n = len;
+      memcpy(sealed + sealedLen, data, n);
+      sealedLen += n;
+      data += n;
+      len -= n;
+      if (sealedLen == Format::SEALED_SIZE && !open(false))
+        return false;
+    }
+    return true;
+  }
+
+  // decode the collected Base64 chars
+  bool decode() {
+    unsigned char decoded[IN_CHARS / 4 * 3];
+    EspStrUtil::ZeroizeOnExit wipeDecoded(decoded, sizeof(decoded));
+    size_t decodedLength = 0;
+    if (!EspStrUtil::base64Decode(decoded, sizeof(decoded), base64, base64Len, &decodedLength)) {
+      return false; // error Base64-decoding
+    }
+    base64Len = 0;
+    return consume(decoded, decodedLength);
+  }
+
+  void wipe() {
+    EspStrUtil::secureZero(sealed, sizeof(sealed));
+    base64Len = 0;
+    headerLen = 0;
+    sealedLen = 0;
+    counter = 0;
+    active = false;
+  }
+
+public:
+  EspAesDecryptor() { mbedtls_gcm_init(&gcm); }
+  ~EspAesDecryptor() {
+    wipe();
+    mbedtls_gcm_free(&gcm);
+  }
+  EspAesDecryptor(const EspAesDecryptor &) = delete;
+  EspAesDecryptor &operator=(const EspAesDecryptor &) = delete;
+
+  /**
+   * *******************************************************************
+   * @brief   start a new decryption stream
+   * @param   key   16-byte AES key used for decryption
+   * @param   sink  callback that receives the plaintext (unverified
+   *                until finish() returns true)
+   * @param   ctx   user context pointer passed to the sink
+   * @return  true if the stream is ready
+   * *******************************************************************/
+  bool init(const unsigned char *key, EspStreamSink sink, void *ctx = NULL) {
+    wipe();
+    if (!key || !sink)
+      return false;
+    if (mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, 128) != 0)
+      return false;
+    this->sink = sink;
+    sinkCtx = ctx;
+    active = true;
+    return true;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   decrypt the next chunk of Base64 input
+   * @param   data  Base64 chunk, line breaks and spaces are ignored
+   * @param   len   length of Base64 chunk
+   * @return  true if successful, false on error, if a chunk failed
+   *          verification or if sink aborted
+   * *******************************************************************/
+  bool update(const char *data, size_t len) {
+    if (!active || (!data && len > 0))
+      return false;
+    for (size_t i = 0; i < len; i++) {
+      char c = data[i];
+      if (c == '\r' || c == '\n' || c == ' ')
+        continue;
+      base64[base64Len++] = c;
+      if (base64Len == IN_CHARS && !decode()) {
+        wipe();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   verify the last chunk and end the stream
+   * @return  true if the complete stream was authentic, only then the
+   *          plaintext passed to the sink is verified
+   * *******************************************************************/
+  bool finish() {
+    bool ok = active && (base64Len == 0 || decode()) && headerLen == Format::HEADER_SIZE && open(true);
+    wipe();
+    return ok;
+  }
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   streaming Base64 encoder for input split into chunks
+ *          writes the encoded output to a sink, memory usage is constant.
+ * *******************************************************************/
+class EspBase64Encoder {
+
+private:
+  static constexpr size_t IN_BYTES = 48; // 48 bytes = 64 Base64 chars without padding
+
+  EspStreamSink sink = NULL;
+  void *sinkCtx = NULL;
+  unsigned char input[IN_BYTES];
+  size_t inputLen = 0;
+  bool urlSafe = false;
+  bool active = false;
+
+  bool flush() {
+    char base64[EspStrUtil::base64EncodedSize(IN_BYTES)];
+    char *end = EspStrUtil::base64Encode(base64, sizeof(base64), input, inputLen, urlSafe);
+    inputLen = 0;
+    return end != NULL && sink(base64, end - base64, sinkCtx);
+  }
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   start a new Base64 stream
+   * @param   sink     callback that receives the Base64 output
+   * @param   ctx      user context pointer passed to the sink
+   * @param   urlSafe  use URL-safe alphabet ('-', '_') without padding
+   * @return  true if the stream is ready
+   * *******************************************************************/
+  bool init(EspStreamSink sink, void *ctx = NULL, bool urlSafe = false) {
+    inputLen = 0;
+    active = sink != NULL;
+    this->sink = sink;
+    sinkCtx = ctx;
+    this->urlSafe = urlSafe;
+    return active;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   encode the next chunk of data
+   * @param   data  input chunk
+   * @param   len   length of input chunk
+   * @return  true if successful, false on error or if sink aborted
+   * *******************************************************************/
+  bool update(const void *data, size_t len) {
+    if (!active || (!data && len > 0))
+      return false;
+    const unsigned char *p = (const unsigned char *)data;
+    while (len > 0) {
+      size_t n = IN_BYTES - inputLen;
+      if (n > len)
+        n = len;
+      memcpy(input + inputLen, p, n);
+      inputLen += n;
+      p += n;
+      len -= n;
+      if (inputLen == IN_BYTES && !flush()) {
+        active = false;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   write the remaining output incl. padding
+   * @return  true if successful, false on error or if sink aborted
+   * *******************************************************************/
+  bool finish() {
+    if (!active)
+      return false;
+    active = false;
+    return inputLen == 0 || flush();
+  }
+};
+
+/**
+ * *******************************************************************
+ * @brief   streaming Base64 decoder for input split into chunks, e.g.
+ *          network packets. Accepts standard and URL-safe alphabet,
+ *          line breaks and spaces are ignored.
+ * *******************************************************************/
+class EspBase64Decoder {
+
+private:
+  static constexpr size_t IN_CHARS = 64; // 64 Base64 chars = 48 bytes
+
+  EspStreamSink sink = NULL;
+  void *sinkCtx = NULL;
+  char base64[IN_CHARS];
+  size_t base64Len = 0;
+  bool padded = false; // padding seen, no more data allowed
+  bool active = false;
+
+  bool flush() {
+    unsigned char output[IN_CHARS / 4 * 3];
+    size_t outputLen = 0;
+    bool ok = EspStrUtil::base64Decode(output, sizeof(output), base64, base64Len, &outputLen);
+    base64Len = 0;
+    return ok && (outputLen == 0 || sink((const char *)output, outputLen, sinkCtx));
+  }
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   start a new Base64 stream
+   * @param   sink  callback that receives the decoded data
+   * @param   ctx   user context pointer passed to the sink
+   * @return  true if the stream is ready
+   * *******************************************************************/
+  bool init(EspStreamSink sink, void *ctx = NULL) {
+    base64Len = 0;
+    padded = false;
+    active = sink != NULL;
+    this->sink = sink;
+    sinkCtx = ctx;
+    return active;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   decode the next chunk of Base64 input
+   * @param   data  Base64 chunk
+   * @param   len   length of Base64 chunk
+   * @return  true if successful, false on invalid input or if sink aborted
+   * *******************************************************************/
+  bool update(const char *data, size_t len) {
+    if (!active || (!data && len > 0))
+      return false;
+    for (size_t i = 0; i < len; i++) {
+      char c = data[i];
+      if (c == '\r' || c == '\n' || c == ' ')
+        continue;
+      if (padded && c != '=') {
+        active = false;
+        return false; // error: data after padding
+      }
+      padded = c == '=';
+      base64[base64Len++] = c;
+      if (base64Len == IN_CHARS && !flush()) {
+        active = false;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   decode the remaining input
+   * @return  true if successful, false on invalid input or if sink aborted
+   * *******************************************************************/
+  bool finish() {
+    if (!active)
+      return false;
+    active = false;
+    return base64Len == 0 || flush();
+  }
+};
@@ -0,0 +1,701 @@
+#pragma once
+
+#include "EspStrBuilder.h"
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   LEB128 varints with zigzag encoding for signed values
+ *          small numbers need one byte (0..127, -64..63), e.g. for
+ *          compact records in flash logs or custom radio frames
+ *
+ *          uint8_t *p = EspVarint::encodeSigned(buf, sizeof(buf), -5);
+ *          const uint8_t *q = EspVarint::decodeSigned(buf, p, value);
+ * *******************************************************************/
+class EspVarint {
+
+public:
+  static constexpr size_t MAX_SIZE = 10; // bytes of a 64-bit value
+
+  static constexpr uint64_t zigzag(int64_t value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+  static constexpr int64_t unzigzag(uint64_t value) { return (int64_t)(value >> 1) ^ -(int64_t)(value & 1); }
+
+  // number of bytes needed for value
+  static constexpr size_t size(uint64_t value) { return value < 0x80 ? 1 : 1 + size(value >> 7); }
+
+  /**
+   * *******************************************************************
+   * @brief   write unsigned varint
+   * @param   buf    destination buffer
+   * @param   size   size of destination buffer
+   * @param   value  value
+   * @return  pointer behind the varint or NULL if buffer to small
+   * *******************************************************************/
+  static uint8_t *encode(uint8_t *buf, size_t size, uint64_t value) {
+    if (buf == NULL || size < EspVarint::size(value))
+      return NULL;
+    while (value >= 0x80) {
+      *buf++ = (uint8_t)(value | 0x80);
+      value >>= 7;
+    }
+    *buf++ = (uint8_t)value;
+    return buf;
+  }
+
+  static uint8_t *encodeSigned(uint8_t *buf, size_t size, int64_t value) { return encode(buf, size, zigzag(value)); }
+
+  /**
+   * *******************************************************************
+   * @brief   read unsigned varint
+   * @param   p      input
+   * @param   end    end of input
+   * @param   value  result, only changed if successful
+   * @return  pointer behind the varint or NULL if truncated or > 64 bit
+   * *******************************************************************/
+  static const uint8_t *decode(const uint8_t *p, const uint8_t *end, uint64_t &value) {
+    uint64_t result = 0;
+    for (int shift = 0; p != NULL && p < end && shift < 64; shift += 7) {
+      uint8_t b = *p++;
+      if (shift == 63 && b > 1)
+        return NULL; // overflow
+      result |= (uint64_t)(b & 0x7F) << shift;
+      if ((b & 0x80) == 0) {
+        value = result;
+        return p;
+      }
+    }
+    return NULL;
+  }
+
+  static const uint8_t *decodeSigned(const uint8_t *p, const uint8_t *end, int64_t &value) {
+    uint64_t u = 0;
+    p = decode(p, end, u);
+    if (p != NULL)
+      value = unzigzag(u);
+    return p;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   IEEE 754 half precision conversion (used by the CBOR writer)
+   *          floatToHalf() rounds to nearest even, overflow gives Inf
+   * *******************************************************************/
+  static uint16_t floatToHalf(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint16_t sign = (uint16_t)((x >> 16) & 0x8000);
+    uint32_t absX = x & 0x7FFFFFFF;
+    if (absX > 0x7F800000)
+      return sign | 0x7E00; // NaN
+    int32_t e = (int32_t)(absX >> 23) - 127;
+    if (e > 15)
+      return sign | 0x7C00; // Inf or to large
+    if (e < -25)
+      return sign; // zero or to small
+    uint32_t mant = (absX & 0x7FFFFF) | 0x800000;
+    int shift = e >= -14 ? 13 : -1 - e; // normal or subnormal half
+    uint32_t h = mant >> shift;
+    uint32_t rem = mant & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (rem > halfway || (rem == halfway && (h & 1)))
+      h++; // a carry into the exponent is correct
+    if (e >= -14)
+      h += (uint32_t)(e + 14) << 10;
+    return h >= 0x7C00 ? (sign | 0x7C00) : (uint16_t)(sign | h);
+  }
+
+  static float halfToFloat(uint16_t h) {
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t mant = h & 0x3FF;
+    float f;
+    if (exp == 0) {
+      f = ldexpf((float)mant, -24);
+    } else if (exp == 31) {
+      f = mant ? NAN : INFINITY;
+    } else {
+      uint32_t x = (exp + 112) << 23 | mant << 13;
+      memcpy(&f, &x, sizeof(f));
+    }
+    return (h & 0x8000) ? -f : f;
+  }
+};
+
+/**
+ * *******************************************************************
+ * @brief   item types of EspCborReader
+ * *******************************************************************/
+enum class EspCborType : uint8_t {
+  Unsigned, // integer >= 0
+  Negative, // integer < 0
+  Bytes,
+  String,
+  Array, // count() items follow
+  Map,   // count() key/value pairs follow
+  Tag,   // tag number count(), one item follows
+  False,
+  True,
+  Null,
+  Undefined,
+  Float, // half, single or double
+  End,   // all input was read
+  Error  // invalid or unsupported input, see EspCborReader::offset()
+};
+
+/**
+ * *******************************************************************
+ * @brief   allocation-free CBOR (RFC 8949) writer into a fixed buffer
+ *          integers use the shortest head, floats the smallest size that
+ *          keeps the value (half, single, double). Arrays and maps have
+ *          a fixed count, the number of items is not checked. Errors
+ *          (buffer to small) are sticky and reported by ok().
+ *
+ *          EspCborWriter cbor(buf, sizeof(buf));
+ *          cbor.beginMap(3);
+ *          cbor.add("temp", 21.5f).add("on", true).add("rssi", -67);
+ *          radio.send(cbor.data(), cbor.length());
+ * *******************************************************************/
+class EspCborWriter {
+
+private:
+  uint8_t *buf;
+  size_t cap;
+  size_t len = 0;
+  bool error = false;
+
+  void put(const void *data, size_t n) {
+    if (error || n > cap - len) {
+      error = true;
+      return;
+    }
+    memcpy(buf + len, data, n);
+    len += n;
+  }
+
+  // initial byte with major type and the argument in the shortest form
+  void head(uint8_t major, uint64_t arg) {
+    uint8_t tmp[9];
+    size_t n = arg < 24 ? 0 : arg <= 0xFF ? 1 : arg <= 0xFFFF ? 2 : arg <= 0xFFFFFFFF ? 4 : 8;
+    tmp[0] = (uint8_t)(major << 5 | (n == 0 ? arg : n == 1 ? 24 : n == 2 ? 25 : n == 4 ? 26 : 27));
+    for (size_t i = n; i > 0; i--) {
+      tmp[i] = (uint8_t)arg; // big-endian
+      arg >>= 8;
+    }
+    put(tmp, n + 1);
+  }
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   CBOR writer into a fixed buffer
+   * @param   buf   destination buffer
+   * @param   size  size of destination buffer
+   * *******************************************************************/
+  EspCborWriter(void *buf, size_t size) : buf((uint8_t *)buf), cap(buf ? size : 0) {}
+  EspCborWriter(const EspCborWriter &) = delete;
+  EspCborWriter &operator=(const EspCborWriter &) = delete;
+
+  EspCborWriter &beginArray(size_t items) {
+    head(4, items);
+    return *this;
+  }
+  EspCborWriter &beginMap(size_t pairs) {
+    head(5, pairs);
+    return *this;
+  }
+  EspCborWriter &tag(uint64_t number) {
+    head(6, number);
+    return *this;
+  }
+
+  // map key, integer keys can be written with value()
+  EspCborWriter &key(const char *key) { return value(key ? key : ""); }
+
+  EspCborWriter &value(const char *str) {
+    if (str == NULL)
+      return nullValue();
+    return value(EspStrView{str, strlen(str)});
+  }
+
+  EspCborWriter &value(EspStrView str) {
+    head(3, str.len);
+    put(str.data, str.len);
+    return *this;
+  }
+
+  EspCborWriter &value(bool b) {
+    uint8_t v = b ? 0xF5 : 0xF4;
+    put(&v, 1);
+    return *this;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   write integer value
+   * @param   number  any 8/16/32/64-bit signed or unsigned integer
+   * @return  reference to this writer
+   * *******************************************************************/
+  template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+  EspCborWriter &value(T number) {
+    if (number < 0) {
+      head(1, ~(uint64_t)(int64_t)number); // -1 - number
+    } else {
+      head(0, (uint64_t)number);
+    }
+    return *this;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   write float value, as half precision if this keeps the value
+   *          (e.g. 21.5), otherwise as single precision
+   * @param   number  float value
+   * @return  reference to this writer
+   * *******************************************************************/
+  EspCborWriter &value(float number) {
+    uint16_t h = EspVarint::floatToHalf(number);
+    float back = EspVarint::halfToFloat(h);
+    if (std::isnan(number) || memcmp(&back, &number, sizeof(number)) == 0) {
+      uint8_t tmp[3] = {0xF9, (uint8_t)(h >> 8), (uint8_t)h};
+      put(tmp, sizeof(tmp));
+      return *this;
+    }
+    uint32_t x;
+    memcpy(&x, &number, sizeof(x));
+    uint8_t tmp[5] = {0xFA, (uint8_t)(x >> 24), (uint8_t)(x >> 16), (uint8_t)(x >> 8), (uint8_t)x};
+    put(tmp, sizeof(tmp));
+    return *this;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   write double value, as float if this keeps the value,
+   *          otherwise as double precision
+   * @param   number  double value
+   * @return  reference to this writer
+   * *******************************************************************/
+  EspCborWriter &value(double number) {
+    float f = (float)number;
+    if (std::isnan(number) || (double)f == number)
+      return value(f);
+    uint64_t x;
+    memcpy(&x, &number, sizeof(x));
+    uint8_t tmp[9] = {0xFB};
+    for (int i = 8; i > 0; i--) {
+      tmp[i] = (uint8_t)x;
+      x >>= 8;
+    }
+    put(tmp, sizeof(tmp));
+    return *this;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   write float value always as half precision (3 bytes),
+   *          rounded to about 3 significant digits, range +-65504
+   * @param   number  float value
+   * @return  reference to this writer
+   * *******************************************************************/
+  EspCborWriter &valueHalf(float number) {
+    uint16_t h = EspVarint::floatToHalf(number);
+    uint8_t tmp[3] = {0xF9, (uint8_t)(h >> 8), (uint8_t)h};
+    put(tmp, sizeof(tmp));
+    return *this;
+  }
+
+  EspCborWriter &bytes(const void *data, size_t n) {
+    head(2, n);
+    put(data, n);
+    return *this;
+  }
+
+  EspCborWriter &nullValue() {
+    uint8_t v = 0xF6;
+    put(&v, 1);
+    return *this;
+  }
+
+  // key/value shortcuts, e.g. cbor.add("temp", 21.5f)
+  template <typename T>
+  EspCborWriter &add(const char *k, T v) { return key(k).value(v); }
+
+  void clear() {
+    len = 0;
+    error = false;
+  }
+
+  bool ok() const { return !error; }
+  const uint8_t *data() const { return buf; }
+  size_t length() const { return len; }
+};
+
+/**
+ * *******************************************************************
+ * @brief   zero-copy CBOR (RFC 8949) pull reader
+ *          reads the input buffer in place item by item, strings are
+ *          views into the input. Indefinite lengths and simple values
+ *          other than false/true/null/undefined are not supported.
+ *
+ *          EspCborReader cbor(data, len);
+ *          if (cbor.next() == EspCborType::Map) {
+ *            for (uint64_t n = cbor.count(); n > 0; n--) {
+ *              cbor.next();
+ *              if (cbor.equals("temp")) {
+ *                cbor.next();
+ *                cbor.asFloat(temp);
+ *              } else {
+ *                cbor.next();
+ *                cbor.skip();
+ *              }
+ *            }
+ *          }
+ *
+ *          debug output: EspCborReader::toText(buf, sizeof(buf), data, len)
+ *          gives {"temp": 21.500, "on": true, "rssi": -67}
+ * *******************************************************************/
+class EspCborReader {
+
+private:
+  static constexpr int MAX_DEPTH = 16; // of toText()
+
+  const uint8_t *start;
+  const uint8_t *p;
+  const uint8_t *end;
+  EspCborType current = EspCborType::End;
+  uint64_t arg = 0;   // integer value, length, count or tag number
+  double number = 0; // value of Float
+  EspStrView str = {NULL, 0};
+
+  EspCborType fail() {
+    p = end;
+    str = {NULL, 0};
+    return current = EspCborType::Error;
+  }
+
+  // fixed-point in the range where it is readable, otherwise exponent notation
+  // like printf("%g"), so 1e300 does not need 300 digits
+  static void appendNumber(EspStrSpan &out, double value, int decimals) {
+    if (decimals < 0)
+      decimals = 0;
+    double absValue = std::fabs(value);
+    if (value == 0 || (absValue < 1e15 && absValue >= std::pow(10.0, -decimals))) {
+      out.appendFloat(value, decimals);
+      return;
+    }
+    char tmp[32];
+    int len = snprintf(tmp, sizeof(tmp), "%.*g", decimals + 1, value);
+    if (len > 0)
+      out.append(tmp, (size_t)len < sizeof(tmp) ? (size_t)len : sizeof(tmp) - 1);
+  }
+
+  // write the bytes as hex in chunks, no extra buffer for the complete string
+  static void appendHex(EspStrSpan &out, EspStrView bytes) {
+    char tmp[33];
+    for (size_t i = 0; i < bytes.len; i += 16) {
+      size_t n = bytes.len - i < 16 ? bytes.len - i : 16;
+      char *e = EspStrUtil::hexEncode(tmp, sizeof(tmp), bytes.data + i, n);
+      out.append(tmp, e - tmp);
+    }
+  }
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   CBOR reader on a buffer, must stay valid while it is used
+   * @param   data  CBOR input (one or more items)
+   * @param   len   length of input
+   * *******************************************************************/
+  EspCborReader(const void *data, size_t len)
+      : start((const uint8_t *)data), p(start), end(data ? start + len : start) {}
+
+  /**
+   * *******************************************************************
+   * @brief   read the next item, arrays, maps and tags are only the head,
+   *          their content are the following items
+   * @return  type of the item
+   * *******************************************************************/
+  EspCborType next() {
+    if (current == EspCborType::Error)
+      return current;
+    str = {NULL, 0};
+    if (p >= end)
+      return current = EspCborType::End;
+    uint8_t b = *p++;
+    uint8_t major = b >> 5;
+    uint8_t info = b & 0x1F;
+    if (major == 7 && info < 24) {
+      switch (info) {
+      case 20:
+        return current = EspCborType::False;
+      case 21:
+        return current = EspCborType::True;
+      case 22:
+        return current = EspCborType::Null;
+      case 23:
+        return current = EspCborType::Undefined;
+      default:
+        return fail(); // unassigned simple value
+      }
+    }
+    if (info < 24) {
+      arg = info;
+    } else if (info <= 27) {
+      size_t n = (size_t)1 << (info - 24);
+      if (n > (size_t)(end - p))
+        return fail(); // truncated
+      arg = 0;
+      for (size_t i = 0; i < n; i++)
+        arg = arg << 8 | *p++;
+    } else {
+      return fail(); // reserved or indefinite length
+    }
+    size_t remaining = end - p;
+    switch (major) {
+    case 0:
+      return current = EspCborType::Unsigned;
+    case 1:
+      return current = EspCborType::Negative;
+    case 2:
+    case 3:
+      if (arg > remaining)
+        return fail();
+      str = {(const char *)p, (size_t)arg};
+      p += arg;
+      return current = major == 2 ? EspCborType::Bytes : EspCborType::String;
+    case 4:
+      // every item needs at least one byte
+      return arg > remaining ? fail() : (current = EspCborType::Array);
+    case 5:
+      return arg > remaining / 2 ? fail() : (current = EspCborType::Map);
+    case 6:
+      return current = EspCborType::Tag;
+    default:
+      if (info == 25) {
+        number = EspVarint::halfToFloat((uint16_t)arg);
+      } else if (info == 26) {
+        uint32_t x = (uint32_t)arg;
+        float f;
+        memcpy(&f, &x, sizeof(f));
+        number = f;
+      } else if (info == 27) {
+        memcpy(&number, &arg, sizeof(number));
+      } else {
+        return fail(); // simple value in next byte
+      }
+      return current = EspCborType::Float;
+    }
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   skip the current item, for arrays, maps and tags also all
+   *          of their content
+   * @return  true if successful
+   * *******************************************************************/
+  bool skip() {
+    uint64_t pending = 0;
+    while (true) {
+      if (current == EspCborType::Error || current == EspCborType::End)
+        return false;
+      if (current == EspCborType::Array)
+        pending += arg;
+      else if (current == EspCborType::Map)
+        pending += arg * 2;
+      else if (current == EspCborType::Tag)
+        pending += 1;
+      if (pending == 0)
+        return true;
+      pending--;
+      next();
+    }
+  }
+
+  EspCborType type() const { return current; }
+
+  // items of Array, pairs of Map, number of Tag
+  uint64_t count() const { return arg; }
+
+  // view of String or Bytes into the input buffer
+  EspStrView text() const { return str; }
+
+  bool equals(const char *s) const {
+    return current == EspCborType::String && s != NULL && strlen(s) == str.len && memcmp(s, str.data, str.len) == 0;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   get integer item
+   * @param   out  result, only changed if successful
+   * @return  true if the item is an integer that fits into T
+   * *******************************************************************/
+  template <typename T>
+  bool asInt(T &out) const {
+    static_assert(std::is_integral<T>::value, "asInt requires an integer type");
+    if (current == EspCborType::Unsigned) {
+      if (arg > (uint64_t)std::numeric_limits<T>::max())
+        return false;
+      out = (T)arg;
+      return true;
+    }
+    if (current == EspCborType::Negative && std::is_signed<T>::value) {
+      // value is -1 - arg, the smallest value is -1 - max
+      if (arg > (uint64_t)std::numeric_limits<T>::max())
+        return false;
+      out = (T)(-1 - (int64_t)arg);
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   get float or integer item as float or double
+   * @param   out  result, only changed if successful
+   * @return  true if the item is a number
+   * *******************************************************************/
+  template <typename T>
+  bool asFloat(T &out) const {
+    static_assert(std::is_floating_point<T>::value, "asFloat requires a float type");
+    if (current == EspCborType::Float)
+      out = (T)number;
+    else if (current == EspCborType::Unsigned)
+      out = (T)arg;
+    else if (current == EspCborType::Negative)
+      out = -1 - (T)arg;
+    else
+      return false;
+    return true;
+  }
+
+  bool asBool(bool &out) const {
+    if (current != EspCborType::True && current != EspCborType::False)
+      return false;
+    out = current == EspCborType::True;
+    return true;
+  }
+
+  // offset of the next item, the end of the input after an error
+  size_t offset() const { return p - start; }
+
+  /**
+   * *******************************************************************
+   * @brief   read the next complete item and append it in diagnostic
+   *          notation, e.g. {"temp": 21.500, "raw": h'0a0b', "n": [1, 2]}
+   *          floats are fixed-point with the given decimals from
+   *          10^-decimals up to 10^15, otherwise in exponent notation
+   *          (1e+300), so large or tiny values fit into small buffers
+   * @param   out       destination
+   * @param   decimals  decimal precision of floats
+   * @return  true if successful, false on invalid input
+   * *******************************************************************/
+  bool toText(EspStrSpan &out, int decimals = 3) {
+    uint64_t total[MAX_DEPTH];
+    uint64_t remaining[MAX_DEPTH];
+    char closer[MAX_DEPTH];
+    int depth = 0;
+    do {
+      EspCborType t = next();
+      if (t == EspCborType::End || t == EspCborType::Error)
+        return false;
+      if (depth > 0) {
+        uint64_t i = total[depth - 1] - remaining[depth - 1];
+        if (closer[depth - 1] == '}' && (i & 1))
+          out.append(": ", 2);
+        else if (i > 0)
+          out.append(", ", 2);
+      }
+      bool done = true;
+      switch (t) {
+      case EspCborType::Unsigned:
+        out.appendInt(arg);
+        break;
+      case EspCborType::Negative:
+        out.append('-');
+        if (arg == UINT64_MAX)
+          out.append("18446744073709551616");
+        else
+          out.appendInt(arg + 1);
+        break;
+      case EspCborType::Bytes:
+        out.append("h'", 2);
+        appendHex(out, str);
+        out.append('\'');
+        break;
+      case EspCborType::String:
+        out.append('"').append(str).append('"');
+        break;
+      case EspCborType::False:
+        out.append("false", 5);
+        break;
+      case EspCborType::True:
+        out.append("true", 4);
+        break;
+      case EspCborType::Null:
+        out.append("null", 4);
+        break;
+      case EspCborType::Undefined:
+        out.append("undefined", 9);
+        break;
+      case EspCborType::Float:
+        if (std::isnan(number))
+          out.append("NaN", 3);
+        else if (std::isinf(number))
+          out.append(number < 0 ? "-Infinity" : "Infinity");
+        else
+          appendNumber(out, number, decimals);
+        break;
+      default: // Array, Map, Tag
+        if (depth >= MAX_DEPTH)
+          return false;
+        if (t == EspCborType::Tag) {
+          out.appendInt(arg).append('(');
+          closer[depth] = ')';
+          total[depth] = 1;
+        } else {
+          out.append(t == EspCborType::Array ? '[' : '{');
+          closer[depth] = t == EspCborType::Array ? ']' : '}';
+          total[depth] = t == EspCborType::Array ? arg : arg * 2;
+        }
+        if (total[depth] == 0) {
+          out.append(closer[depth]);
+        } else {
+          remaining[depth] = total[depth];
+          depth++;
+          done = false;
+        }
+        break;
+      }
+      // close all containers that are complete now
+      while (done && depth > 0 && --remaining[depth - 1] == 0) {
+        out.append(closer[depth - 1]);
+        depth--;
+      }
+    } while (depth > 0);
+    return !out.overflow();
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   convert CBOR to diagnostic notation for debug output,
+   *          several top-level items are separated by ", "
+   * @param   buf       destination buffer
+   * @param   size      size of destination buffer (incl. '\0')
+   * @param   data      CBOR input
+   * @param   len       length of input
+   * @param   decimals  decimal precision of floats
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   *          or input invalid
+   * *******************************************************************/
+  static char *toText(char *buf, size_t size, const void *data, size_t len, int decimals = 3) {
+    if (buf == NULL || size == 0)
+      return NULL;
+    EspStrSpan out(buf, size);
+    EspCborReader reader(data, len);
+    while (reader.p < reader.end) {
+      if (reader.p > reader.start)
+        out.append(", ", 2);
+      if (!reader.toText(out, decimals))
+        return NULL;
+    }
+    return out.overflow() ? NULL : buf + out.length();
+  }
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   change detection for many published values
+ *          generalizes EspStrUtil::strDiff(): every slot stores the raw
+ *          numeric value (or the hash of a string) of the last change,
+ *          so values do not need to be formatted just to compare them.
+ *          Floats can have a deadband. Changed slots are marked in a
+ *          dirty bitset and can be iterated for batch publishing.
+ *          Storage is struct-of-arrays with N slots, no allocation.
+ *
+ *          EspChangeTracker<300> tracker;
+ *          int tempSlot = tracker.add("temp", 0.2f);
+ *          tracker.update(tempSlot, sensorTemp);
+ *          for (size_t slot : tracker.dirty()) {
+ *            publish(slot, tracker.getFloat(slot));
+ *          }
+ *          tracker.clearDirty();
+ * *******************************************************************/
+template <size_t N>
+class EspChangeTracker {
+
+public:
+  enum Type : uint8_t { NONE, INT, UINT, FLOAT, BOOL, STRING };
+
+private:
+  static constexpr size_t WORDS = (N + 31) / 32;
+
+  uint32_t keys[N];      // key hash
+  uint32_t values[N];    // raw value bits or string hash
+  float deadbands[N];    // min. change for floats
+  uint8_t types[N];      // Type of the stored value
+  uint32_t dirtyBits[WORDS] = {};
+  size_t count = 0;
+
+  static uint32_t floatBits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+  }
+
+  bool store(size_t slot, Type type, uint32_t bits) {
+    if (slot >= count)
+      return false;
+    if (types[slot] == type && values[slot] == bits)
+      return false;
+    types[slot] = type;
+    values[slot] = bits;
+    dirtyBits[slot / 32] |= 1u << (slot % 32);
+    return true;
+  }
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   iterator over the dirty slots (for range based for loop)
+   * *******************************************************************/
+  class DirtyIterator {
+    const uint32_t *bits;
+    size_t slot;
+
+    void seek() {
+      while (slot < WORDS * 32) {
+        uint32_t word = bits[slot / 32] >> (slot % 32);
+        if (word == 0) {
+          slot = (slot / 32 + 1) * 32; // skip to next word
+          continue;
+        }
+        slot += __builtin_ctz(word);
+        return;
+      }
+    }
+
+  public:
+    DirtyIterator(const uint32_t *bits, size_t slot) : bits(bits), slot(slot) { seek(); }
+    size_t operator*() const { return slot; }
+    DirtyIterator &operator++() {
+      slot++;
+      seek();
+      return *this;
+    }
+    bool operator!=(const DirtyIterator &other) const { return slot < other.slot; }
+  };
+
+  struct DirtyRange {
+    const uint32_t *bits;
+    DirtyIterator begin() const { return DirtyIterator(bits, 0); }
+    DirtyIterator end() const { return DirtyIterator(bits, WORDS * 32); }
+  };
+
+  /**
+   * *******************************************************************
+   * @brief   add a new slot
+   * @param   key       key hash, e.g. EspStrUtil::hash32("temp")
+   * @param   deadband  min. change of float values to mark them dirty
+   * @return  slot index or -1 if the table is full
+   * *******************************************************************/
+  int add(uint32_t key, float deadband = 0.0f) {
+    if (count >= N)
+      return -1;
+    keys[count] = key;
+    values[count] = 0;
+    deadbands[count] = deadband;
+    types[count] = NONE; // first update is always a change
+    return (int)count++;
+  }
+
+  int add(const char *name, float deadband = 0.0f) { return add(EspStrUtil::hash32(name), deadband); }
+
+  /**
+   * *******************************************************************
+   * @brief   find the slot of a key
+   * @param   key  key hash
+   * @return  slot index or -1 if not found
+   * *******************************************************************/
+  int find(uint32_t key) const {
+    for (size_t i = 0; i < count; i++) {
+      if (keys[i] == key)
+        return (int)i;
+    }
+    return -1;
+  }
+
+  int find(const char *name) const { return find(EspStrUtil::hash32(name)); }
+
+  /**
+   * *******************************************************************
+   * @brief   update slot with a new value
+   * @param   slot   slot index
+   * @param   value  new value (integer up to 32-bit, bool, float or string)
+   * @return  true if the value has changed, the slot is marked dirty
+   * *******************************************************************/
+  template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+  bool update(size_t slot, T value) {
+    static_assert(sizeof(T) <= sizeof(uint32_t), "EspChangeTracker stores up to 32-bit integers");
+    return store(slot, std::is_signed<T>::value ? INT : UINT, (uint32_t)value);
+  }
+
+  bool update(size_t slot, bool value) { return store(slot, BOOL, value ? 1 : 0); }
+
+  bool update(size_t slot, float value) {
+    if (slot >= count)
+      return false;
+    if (types[slot] == FLOAT && deadbands[slot] > 0.0f) {
+      float last;
+      memcpy(&last, &values[slot], sizeof(last));
+      float diff = value - last;
+      if (diff <= deadbands[slot] && diff >= -deadbands[slot])
+        return false; // within deadband, keep last published value
+    }
+    return store(slot, FLOAT, floatBits(value));
+  }
+
+  bool update(size_t slot, double value) { return update(slot, (float)value); }
+
+  bool update(size_t slot, const char *value) {
+    return store(slot, STRING, value ? EspStrUtil::hash32(value) : 0);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   update slot by key name (see update)
+   * @param   name   key name
+   * @param   value  new value
+   * @return  true if the value has changed
+   * *******************************************************************/
+  template <typename T>
+  bool updateKey(const char *name, T value) {
+    int slot = find(name);
+    return slot >= 0 && update((size_t)slot, value);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   range of dirty slots: for (size_t slot : tracker.dirty())
+   * @return  iterable range
+   * *******************************************************************/
+  DirtyRange dirty() const { return DirtyRange{dirtyBits}; }
+
+  bool isDirty(size_t slot) const { return slot < count && (dirtyBits[slot / 32] & (1u << (slot % 32))); }
+  void clearDirty(size_t slot) {
+    if (slot < count)
+      dirtyBits[slot / 32] &= ~(1u << (slot % 32));
+  }
+  void clearDirty() { memset(dirtyBits, 0, sizeof(dirtyBits)); }
+
+  // mark all used slots dirty, e.g. after a reconnect to publish everything again
+  void markAllDirty() {
+    for (size_t i = 0; i < count; i++)
+      dirtyBits[i / 32] |= 1u << (i % 32);
+  }
+
+  size_t dirtyCount() const {
+    size_t n = 0;
+    for (size_t i = 0; i < WORDS; i++)
+      n += __builtin_popcount(dirtyBits[i]);
+    return n;
+  }
+
+  // raw access to the last changed values
+  Type getType(size_t slot) const { return slot < count ? (Type)types[slot] : NONE; }
+  uint32_t getKey(size_t slot) const { return slot < count ? keys[slot] : 0; }
+  int32_t getInt(size_t slot) const { return slot < count ? (int32_t)values[slot] : 0; }
+  uint32_t getUInt(size_t slot) const { return slot < count ? values[slot] : 0; }
+  bool getBool(size_t slot) const { return slot < count && values[slot] != 0; }
+  float getFloat(size_t slot) const {
+    float f = 0.0f;
+    if (slot < count)
+      memcpy(&f, &values[slot], sizeof(f));
+    return f;
+  }
+
+  size_t size() const { return count; }
+  size_t capacity() const { return N; }
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   one entry for the batch functions of EspCipher
+ * *******************************************************************/
+struct EspCipherJob {
+  const char *input;    // input string (plaintext or Base64)
+  char *output;         // output buffer
+  size_t maxOutputSize; // size of output buffer
+  bool ok;              // result of this entry
+  bool legacy;          // decryptSecretBatch(): input was in legacy format
+};
+
+/**
+ * *******************************************************************
+ * @brief   reusable AES cipher with cached key schedules
+ *          same format as EspStrUtil::encryptPassword() and
+ *          EspStrUtil::decryptPassword() resp. encryptSecret() and
+ *          decryptSecret(), but the key is expanded only once in setKey().
+ *          The key schedules are zeroized by clear() and on destruction.
+ * *******************************************************************/
+class EspCipher {
+
+private:
+  mbedtls_aes_context aesEnc;
+  mbedtls_aes_context aesDec;
+  mbedtls_gcm_context gcm;
+  bool hasKey = false;
+
+public:
+  EspCipher() {
+    mbedtls_aes_init(&aesEnc);
+    mbedtls_aes_init(&aesDec);
+    mbedtls_gcm_init(&gcm);
+  }
+  explicit EspCipher(const unsigned char *key) : EspCipher() { setKey(key); }
+  ~EspCipher() { clear(); }
+  EspCipher(const EspCipher &) = delete;
+  EspCipher &operator=(const EspCipher &) = delete;
+
+  /**
+   * *******************************************************************
+   * @brief   expand a new key for encryption and decryption
+   * @param   key   16-byte AES key
+   * @return  true if successful
+   * *******************************************************************/
+  bool setKey(const unsigned char *key) {
+    clear();
+    if (!key)
+      return false;
+    hasKey = mbedtls_aes_setkey_enc(&aesEnc, key, 128) == 0 && mbedtls_aes_setkey_dec(&aesDec, key, 128) == 0 &&
+             mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, 128) == 0;
+    if (!hasKey)
+      clear();
+    return hasKey;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   zeroize the key schedules, setKey() is needed again
+   * @return  none
+   * *******************************************************************/
+  void clear() {
+    // mbedtls_*_free() zeroizes the context
+    mbedtls_aes_free(&aesEnc);
+    mbedtls_aes_free(&aesDec);
+    mbedtls_gcm_free(&gcm);
+    mbedtls_aes_init(&aesEnc);
+    mbedtls_aes_init(&aesDec);
+    mbedtls_gcm_init(&gcm);
+    hasKey = false;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   check if a key is set
+   * @return  true if a key is set
+   * *******************************************************************/
+  bool valid() const { return hasKey; }
+
+  /**
+   * *******************************************************************
+   * @brief   Encrypts a password and encodes it in Base64 format
+   * @param   input         Plaintext password to be encrypted
+   * @param   output        Buffer to store the Base64-encoded, encrypted
+   * password
+   * @param   maxOutputSize Maximum size of the output buffer
+   * @return  true if encryption and Base64 encoding is successful
+   * *******************************************************************/
+  bool encrypt(const char *input, char *output, size_t maxOutputSize) {
+    if (!hasKey || !input || !output || maxOutputSize == 0)
+      return false;
+    return EspStrUtil::encryptWithContext(&aesEnc, input, output, maxOutputSize);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   Decrypts a Base64-encoded, encrypted password
+   * @param   input         Base64-encoded encrypted password
+   * @param   output        Buffer to store the decrypted password
+   * @param   maxOutputSize Maximum size of the output buffer
+   * @return  true if decryption and padding removal were successful
+   * *******************************************************************/
+  bool decrypt(const char *input, char *output, size_t maxOutputSize) {
+    if (!hasKey || !input || !output || maxOutputSize == 0)
+      return false;
+    return EspStrUtil::decryptWithContext(&aesDec, input, output, maxOutputSize);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   Encrypts a secret into the authenticated envelope format
+   *          (see EspStrUtil::encryptSecret)
+   * @param   input         Plaintext secret to be encrypted
+   * @param   output        Buffer to store the Base64-encoded envelope
+   * @param   maxOutputSize Maximum size of the output buffer
+   * @return  true if encryption and Base64 encoding is successful
+   * *******************************************************************/
+  bool encryptSecret(const char *input, char *output, size_t maxOutputSize) {
+    if (!hasKey || !input || !output || maxOutputSize == 0)
+      return false;
+    return EspStrUtil::encryptSecretWithContext(&gcm, input, output, maxOutputSize);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   Decrypts and verifies a secret, also accepts the legacy
+   *          format (see EspStrUtil::decryptSecret)
+   * @param   input         Base64-encoded envelope or legacy password
+   * @param   output        Buffer to store the decrypted secret
+   * @param   maxOutputSize Maximum size of the output buffer
+   * @param   legacy        optional: set to true if the input was in the
+   *                        legacy format and should be encrypted again
+   * @return  true if decryption and verification were successful
+   * *******************************************************************/
+  bool decryptSecret(const char *input, char *output, size_t maxOutputSize, bool *legacy = NULL) {
+    if (!hasKey || !input || !output || maxOutputSize == 0)
+      return false;
+    return EspStrUtil::decryptSecretWithContext(&gcm, &aesDec, NULL, input, output, maxOutputSize, legacy);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   encrypt many passwords with the same key
+   * @param   jobs   array of jobs, the result is stored in jobs[i].ok
+   * @param   count  number of jobs
+   * @return  number of successful jobs
+   * *******************************************************************/
+  size_t encryptBatch(EspCipherJob *jobs, size_t count) {
+    size_t success = 0;
+    for (size_t i = 0; jobs && i < count; i++) {
+      jobs[i].ok = encrypt(jobs[i].input, jobs[i].output, jobs[i].maxOutputSize);
+      success += jobs[i].ok;
+    }
+    return success;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   decrypt many passwords with the same key
+   * @param   jobs   array of jobs, the result is stored in jobs[i].ok
+   * @param   count  number of jobs
+   * @return  number of successful jobs
+   * *******************************************************************/
+  size_t decryptBatch(EspCipherJob *jobs, size_t count) {
+    size_t success = 0;
+    for (size_t i = 0; jobs && i < count; i++) {
+      jobs[i].ok = decrypt(jobs[i].input, jobs[i].output, jobs[i].maxOutputSize);
+      success += jobs[i].ok;
+    }
+    return success;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   encrypt many secrets with the same key
+   * @param   jobs   array of jobs, the result is stored in jobs[i].ok
+   * @param   count  number of jobs
+   * @return  number of successful jobs
+   * *******************************************************************/
+  size_t encryptSecretBatch(EspCipherJob *jobs, size_t count) {
+    size_t success = 0;
+    for (size_t i = 0; jobs && i < count; i++) {
+      jobs[i].ok = encryptSecret(jobs[i].input, jobs[i].output, jobs[i].maxOutputSize);
+      success += jobs[i].ok;
+    }
+    return success;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   decrypt many secrets with the same key
+   * @param   jobs   array of jobs, the result is stored in jobs[i].ok
+   *                 and jobs[i].legacy
+   * @param   count  number of jobs
+   * @return  number of successful jobs
+   * *******************************************************************/
+  size_t decryptSecretBatch(EspCipherJob *jobs, size_t count) {
+    size_t success = 0;
+    for (size_t i = 0; jobs && i < count; i++) {
+      jobs[i].ok = decryptSecret(jobs[i].input, jobs[i].output, jobs[i].maxOutputSize, &jobs[i].legacy);
+      success += jobs[i].ok;
+    }
+    return success;
+  }
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   incremental xxHash32, gives the same result as
+ *          EspStrUtil::xxHash32() over the concatenated data
+ *
+ *          EspXxHash32 h;
+ *          h.update(part1, len1);
+ *          h.update(part2, len2);
+ *          uint32_t hash = h.digest();
+ * *******************************************************************/
+class EspXxHash32 {
+
+private:
+  uint32_t v1, v2, v3, v4;
+  uint32_t seed;
+  uint32_t totalLen;
+  char stripe[16];
+  size_t stripeLen;
+
+  void consume(const char *p) {
+    v1 = EspStrUtil::xxhRound(v1, EspStrUtil::readLE32(p));
+    v2 = EspStrUtil::xxhRound(v2, EspStrUtil::readLE32(p + 4));
+    v3 = EspStrUtil::xxhRound(v3, EspStrUtil::readLE32(p + 8));
+    v4 = EspStrUtil::xxhRound(v4, EspStrUtil::readLE32(p + 12));
+  }
+
+public:
+  explicit EspXxHash32(uint32_t seed = 0) { reset(seed); }
+
+  /**
+   * *******************************************************************
+   * @brief   start a new hash
+   * @param   seed  optional seed
+   * @return  none
+   * *******************************************************************/
+  void reset(uint32_t seed = 0) {
+    this->seed = seed;
+    v1 = seed + EspStrUtil::XXH_PRIME1 + EspStrUtil::XXH_PRIME2;
+    v2 = seed + EspStrUtil::XXH_PRIME2;
+    v3 = seed;
+    v4 = seed - EspStrUtil::XXH_PRIME1;
+    totalLen = 0;
+    stripeLen = 0;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   add data to the hash
+   * @param   data  input data
+   * @param   len   length of input data
+   * @return  reference to this hash
+   * *******************************************************************/
+  EspXxHash32 &update(const void *data, size_t len) {
+    const char *p = (const char *)data;
+    totalLen += (uint32_t)len;
+    if (stripeLen > 0) {
+      size_t n = sizeof(stripe) - stripeLen;
+      if (n > len)
+        n = len;
+      memcpy(stripe + stripeLen, p, n);
+      stripeLen += n;
+      p += n;
+      len -= n;
+      if (stripeLen < sizeof(stripe))
+        return *this;
+      consume(stripe);
+      stripeLen = 0;
+    }
+    for (; len >= sizeof(stripe); len -= sizeof(stripe), p += sizeof(stripe)) {
+      consume(p);
+    }
+    memcpy(stripe, p, len);
+    stripeLen = len;
+    return *this;
+  }
+
+  EspXxHash32 &update(const char *str) { return update(str, str ? strlen(str) : 0); }
+
+  /**
+   * *******************************************************************
+   * @brief   get the hash of all data added so far
+   * @return  32-bit hash value
+   * *******************************************************************/
+  uint32_t digest() const {
+    uint32_t h;
+    if (totalLen >= sizeof(stripe)) {
+      h = EspStrUtil::rotl32(v1, 1) + EspStrUtil::rotl32(v2, 7) + EspStrUtil::rotl32(v3, 12) + EspStrUtil::rotl32(v4, 18);
+    } else {
+      h = seed + EspStrUtil::XXH_PRIME5;
+    }
+    h += totalLen;
+    return EspStrUtil::xxhFinalize(h, stripe, stripeLen);
+  }
+};
@@ -0,0 +1,307 @@
+#pragma once
+
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   allocation-free JSON writer
+ *          writes into a fixed buffer or uses the buffer as chunk buffer
+ *          and flushes it to a sink whenever it is full, so the complete
+ *          document never needs to be in RAM. Errors (overflow, sink
+ *          abort, wrong nesting) are sticky and reported by ok().
+ *
+ *          EspJsonWriter json(buf, sizeof(buf));
+ *          json.beginObject();
+ *          json.add("temp", 21.5f, 1).add("on", true);
+ *          json.beginArray("list").value(1).value(2).endArray();
+ *          json.endObject();
+ * *******************************************************************/
+class EspJsonWriter {
+
+private:
+  static constexpr int MAX_DEPTH = 32;
+
+  char *buf;
+  size_t cap; // buffer size without '\0'
+  size_t len = 0;
+  EspStreamSink sink = NULL;
+  void *sinkCtx = NULL;
+  uint32_t hasElements = 0; // bit per nesting level: comma needed
+  uint32_t isObject = 0;    // bit per nesting level: object or array
+  int depth = 0;
+  bool afterKey = false;
+  bool error = false;
+
+  bool flush() {
+    if (sink == NULL || error)
+      return false;
+    if (len > 0 && !sink(buf, len, sinkCtx)) {
+      error = true;
+      return false;
+    }
+    len = 0;
+    return true;
+  }
+
+  void put(const char *str, size_t n) {
+    while (!error && n > 0) {
+      size_t space = cap - len;
+      if (space == 0) {
+        if (!flush()) {
+          error = true; // fixed buffer to small
+          break;
+        }
+        continue;
+      }
+      size_t chunk = n < space ? n : space;
+      memcpy(buf + len, str, chunk);
+      len += chunk;
+      str += chunk;
+      n -= chunk;
+    }
+    buf[len] = '\0';
+  }
+
+  void put(char c) { put(&c, 1); }
+
+  // write comma if needed, check that a key is given inside of objects
+  void separator(bool isKey) {
+    uint32_t bit = depth > 0 ? 1u << (depth - 1) : 0;
+    if (afterKey) {
+      afterKey = false;
+      if (isKey)
+        error = true; // two keys in a row
+      return;
+    }
+    if (depth > 0 && ((isObject & bit) != 0) != isKey) {
+      error = true; // key missing in object or key in array
+      return;
+    }
+    if (hasElements & bit)
+      put(',');
+    hasElements |= bit;
+  }
+
+  void putEscaped(const char *str, size_t n) {
+    static const char hexChars[] = "0123456789abcdef";
+    put('"');
+    size_t start = 0;
+    for (size_t i = 0; i < n; i++) {
+      unsigned char c = (unsigned char)str[i];
+      if (c >= 0x20 && c != '"' && c != '\\')
+        continue;
+      put(str + start, i - start); // write run of safe chars at once
+      start = i + 1;
+      char esc[6] = {'\\', 0, 0, 0, 0, 0};
+      size_t escLen = 2;
+      switch (c) {
+      case '"':
+        esc[1] = '"';
+        break;
+      case '\\':
+        esc[1] = '\\';
+        break;
+      case '\b':
+        esc[1] = 'b';
+        break;
+      case '\f':
+        esc[1] = 'f';
+        break;
+      case '\n':
+        esc[1] = 'n';
+        break;
+      case '\r':
+        esc[1] = 'r';
+        break;
+      case '\t':
+        esc[1] = 't';
+        break;
+      default:
+        esc[1] = 'u';
+        esc[2] = '0';
+        esc[3] = '0';
+        esc[4] = hexChars[c >> 4];
+        esc[5] = hexChars[c & 0xF];
+        escLen = 6;
+        break;
+      }
+      put(esc, escLen);
+    }
+    put(str + start, n - start);
+    put('"');
+  }
+
+  EspJsonWriter &open(const char *key, char bracket, bool object) {
+    if (key)
+      this->key(key);
+    separator(false);
+    if (depth >= MAX_DEPTH) {
+      error = true;
+      return *this;
+    }
+    depth++;
+    uint32_t bit = 1u << (depth - 1);
+    hasElements &= ~bit;
+    if (object) {
+      isObject |= bit;
+    } else {
+      isObject &= ~bit;
+    }
+    put(bracket);
+    return *this;
+  }
+
+  EspJsonWriter &close(char bracket, bool object) {
+    uint32_t bit = depth > 0 ? 1u << (depth - 1) : 0;
+    if (depth == 0 || afterKey || ((isObject & bit) != 0) != object) {
+      error = true;
+      return *this;
+    }
+    depth--;
+    put(bracket);
+    return *this;
+  }
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   JSON writer into a fixed buffer
+   * @param   buf   destination buffer
+   * @param   size  size of destination buffer (incl. '\0'), must be > 1
+   * *******************************************************************/
+  EspJsonWriter(char *buf, size_t size) : buf(buf), cap(size - 1) { buf[0] = '\0'; }
+
+  /**
+   * *******************************************************************
+   * @brief   JSON writer with chunk buffer that is flushed to a sink
+   * @param   buf   chunk buffer
+   * @param   size  size of chunk buffer, must be > 1
+   * @param   sink  callback that receives the JSON output in chunks
+   * @param   ctx   user context pointer passed to the sink
+   * *******************************************************************/
+  EspJsonWriter(char *buf, size_t size, EspStreamSink sink, void *ctx = NULL)
+      : buf(buf), cap(size - 1), sink(sink), sinkCtx(ctx) {
+    buf[0] = '\0';
+  }
+  EspJsonWriter(const EspJsonWriter &) = delete;
+  EspJsonWriter &operator=(const EspJsonWriter &) = delete;
+
+  EspJsonWriter &beginObject(const char *key = NULL) { return open(key, '{', true); }
+  EspJsonWriter &endObject() { return close('}', true); }
+  EspJsonWriter &beginArray(const char *key = NULL) { return open(key, '[', false); }
+  EspJsonWriter &endArray() { return close(']', false); }
+
+  /**
+   * *******************************************************************
+   * @brief   write object key, must be followed by a value
+   * @param   key  key string, will be escaped
+   * @return  reference to this writer
+   * *******************************************************************/
+  EspJsonWriter &key(const char *key) {
+    separator(true);
+    putEscaped(key ? key : "", key ? strlen(key) : 0);
+    put(':');
+    afterKey = true;
+    return *this;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   write string value, will be escaped (NULL writes null)
+   * @param   str  string value
+   * @return  reference to this writer
+   * *******************************************************************/
+  EspJsonWriter &value(const char *str) {
+    if (str == NULL)
+      return nullValue();
+    separator(false);
+    putEscaped(str, strlen(str));
+    return *this;
+  }
+
+  EspJsonWriter &value(EspStrView str) {
+    separator(false);
+    putEscaped(str.data, str.len);
+    return *this;
+  }
+
+  EspJsonWriter &value(bool b) {
+    separator(false);
+    b ? put("true", 4) : put("false", 5);
+    return *this;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   write integer value
+   * @param   number  any 8/16/32/64-bit signed or unsigned integer
+   * @return  reference to this writer
+   * *******************************************************************/
+  template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+  EspJsonWriter &value(T number) {
+    char tmp[24];
+    char *end = EspStrUtil::toChars(tmp, sizeof(tmp), number);
+    separator(false);
+    put(tmp, end - tmp);
+    return *this;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   write float value, NaN and Inf are written as null
+   * @param   number    float or double value
+   * @param   decimals  decimal precision
+   * @return  reference to this writer
+   * *******************************************************************/
+  template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+  EspJsonWriter &value(T number, int decimals = 1) {
+    if (!std::isfinite(number))
+      return nullValue();
+    char tmp[64];
+    char *end = EspStrUtil::floatToChars(tmp, sizeof(tmp), number, decimals);
+    if (end == NULL)
+      return nullValue();
+    separator(false);
+    put(tmp, end - tmp);
+    return *this;
+  }
+
+  EspJsonWriter &nullValue() {
+    separator(false);
+    put("null", 4);
+    return *this;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   write pre-formatted JSON value as it is
+   * @param   json  valid JSON value
+   * @return  reference to this writer
+   * *******************************************************************/
+  EspJsonWriter &rawValue(const char *json) {
+    separator(false);
+    put(json, json ? strlen(json) : 0);
+    return *this;
+  }
+
+  // key/value shortcuts, e.g. json.add("temp", 21.5f, 1)
+  template <typename T>
+  EspJsonWriter &add(const char *k, T v) { return key(k).value(v); }
+  template <typename T>
+  EspJsonWriter &add(const char *k, T v, int decimals) { return key(k).value(v, decimals); }
+
+  /**
+   * *******************************************************************
+   * @brief   flush remaining output to the sink (sink mode only)
+   * @return  true if the document is complete and without errors
+   * *******************************************************************/
+  bool finish() {
+    if (sink != NULL)
+      flush();
+    return ok() && depth == 0;
+  }
+
+  bool ok() const { return !error; }
+  const char *c_str() const { return buf; }
+  size_t length() const { return len; }
+};
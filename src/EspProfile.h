@@ -0,0 +1,221 @@
+#pragma once
+
+#include "EspJsonWriter.h"
+#include "EspStrBuilder.h"
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   report of the EspStrUtil instrumentation
+ *          the counters are only recorded if the project is built with
+ *          -DESP_STR_UTIL_PROFILE, otherwise all functions report nothing.
+ *          Cycles are CPU cycles on the ESP32 and ns on host builds
+ *          (or the unit of the clock given to setClock()).
+ *          Nested calls are not counted twice: only the outermost call
+ *          counts, e.g. encryptPassword() includes its Base64 encoding,
+ *          which does not show up under base64Encode.
+ *
+ *          EspProfile::reset();
+ *          ... run the application for a while ...
+ *          char buf[1024];
+ *          EspProfile::toText(buf, sizeof(buf));
+ *          Serial.print(buf);
+ * *******************************************************************/
+class EspProfile {
+
+private:
+  static constexpr size_t COUNT = (size_t)EspProfileId::Count;
+
+  // fill with spaces up to the given column
+  static void pad(EspStrSpan &line, size_t column) {
+    do {
+      line.append(' ');
+    } while (line.length() < column);
+  }
+
+  // copy of all totals, so the report does not count itself
+  struct Snapshot {
+    EspProfileCounter totals[COUNT];
+    Snapshot() {
+      for (size_t i = 0; i < COUNT; i++)
+        totals[i] = total((EspProfileId)i);
+    }
+  };
+
+  static bool putLine(EspStrSpan &line, EspStreamSink sink, void *ctx) {
+    line.append('\n');
+    bool ok = !line.overflow() && sink(line.c_str(), line.length(), ctx);
+    line.clear();
+    return ok;
+  }
+
+public:
+  // true if the instrumentation is compiled in
+  static constexpr bool enabled() {
+#if defined(ESP_STR_UTIL_PROFILE)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   name of a function group
+   * @param   id  function group
+   * @return  name, e.g. "toChars"
+   * *******************************************************************/
+  static const char *name(EspProfileId id) {
+    static const char *const names[COUNT] = {"toChars",      "floatToChars", "encrypt",     "decrypt",   "encryptSecret",
+                                             "decryptSecret", "base64Encode", "base64Decode", "dateTime",  "hash",
+                                             "transform",     "parse",        "format",       "strcat"};
+    return (size_t)id < COUNT ? names[(size_t)id] : "";
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   counters of a function group, summed up over all cores
+   *          (may be slightly inconsistent while other cores are running)
+   * @param   id  function group
+   * @return  counters
+   * *******************************************************************/
+  static EspProfileCounter total(EspProfileId id) {
+    EspProfileCounter sum = {};
+    (void)id;
+#if defined(ESP_STR_UTIL_PROFILE)
+    EspProfileData &data = EspProfileData::get();
+    for (int core = 0; core < EspProfileData::CORES && (size_t)id < COUNT; core++) {
+      EspProfileCounter c = data.read(core, id);
+      sum.calls += c.calls;
+      sum.cycles += c.cycles;
+      sum.bytes += c.bytes;
+      if (c.maxCycles > sum.maxCycles)
+        sum.maxCycles = c.maxCycles;
+    }
+#endif
+    return sum;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   clear all counters
+   * @return  none
+   * *******************************************************************/
+  static void reset() {
+#if defined(ESP_STR_UTIL_PROFILE)
+    // each core clears its own table on its next update, see EspProfileData
+    EspProfileData::get().generation.fetch_add(1, std::memory_order_relaxed);
+#endif
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   replace the clock, e.g. a timer with higher resolution
+   * @param   clock  function returning a free running 32-bit counter
+   * @return  none
+   * *******************************************************************/
+  static void setClock(EspProfileClock clock) {
+#if defined(ESP_STR_UTIL_PROFILE)
+    EspProfileData::get().clock.store(clock ? clock : EspProfileData::defaultClock, std::memory_order_relaxed);
+#else
+    (void)clock;
+#endif
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   write all used function groups as JSON:
+   *          {"toChars":{"calls":10,"cycles":1200,"max":250,"bytes":40},...}
+   * @param   json  JSON writer, the object is added as value
+   * @return  reference to the JSON writer
+   * *******************************************************************/
+  static EspJsonWriter &toJson(EspJsonWriter &json) {
+    Snapshot snapshot;
+    json.beginObject();
+    for (size_t i = 0; i < COUNT; i++) {
+      const EspProfileCounter &c = snapshot.totals[i];
+      if (c.calls == 0)
+        continue;
+      json.beginObject(name((EspProfileId)i));
+      json.add("calls", c.calls).add("cycles", c.cycles).add("max", c.maxCycles).add("bytes", c.bytes);
+      json.endObject();
+    }
+    return json.endObject();
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   JSON report into a buffer (see toJson)
+   * @param   buf   destination buffer
+   * @param   size  size of destination buffer (incl. '\0')
+   * @return  true if successful, false if buffer to small
+   * *******************************************************************/
+  static bool toJson(char *buf, size_t size) {
+    if (buf == NULL || size < 2)
+      return false;
+    EspJsonWriter json(buf, size);
+    return toJson(json).finish();
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   text report, one line per used function group:
+   *          name  calls  total cycles  avg cycles  max cycles  bytes
+   * @param   sink  callback that receives the report line by line
+   * @param   ctx   user context pointer passed to the sink
+   * @return  true if successful
+   * *******************************************************************/
+  static bool toText(EspStreamSink sink, void *ctx = NULL) {
+    if (sink == NULL)
+      return false;
+    Snapshot snapshot;
+    EspStrBuilder<128> line;
+    line.append("function");
+    pad(line, 14);
+    line.append("calls");
+    pad(line, 25);
+    line.append("cycles");
+    pad(line, 38);
+    line.append("avg");
+    pad(line, 47);
+    line.append("max");
+    pad(line, 56);
+    line.append("bytes");
+    if (!putLine(line, sink, ctx))
+      return false;
+    for (size_t i = 0; i < COUNT; i++) {
+      const EspProfileCounter &c = snapshot.totals[i];
+      if (c.calls == 0)
+        continue;
+      line.append(name((EspProfileId)i));
+      pad(line, 14);
+      line.appendInt(c.calls);
+      pad(line, 25);
+      line.appendInt(c.cycles);
+      pad(line, 38);
+      line.appendInt(c.cycles / c.calls);
+      pad(line, 47);
+      line.appendInt(c.maxCycles);
+      pad(line, 56);
+      line.appendInt(c.bytes);
+      if (!putLine(line, sink, ctx))
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   text report into a buffer (see toText)
+   * @param   buf   destination buffer
+   * @param   size  size of destination buffer (incl. '\0')
+   * @return  true if successful, false if buffer to small
+   * *******************************************************************/
+  static bool toText(char *buf, size_t size) {
+    if (buf == NULL || size == 0)
+      return false;
+    EspStrSpan out(buf, size);
+    bool ok = toText(EspStrSpan::sink, &out);
+    return ok && !out.overflow();
+  }
+};
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "EspStrBuilder.h"
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   bump-pointer string storage on a caller buffer
+ *          strings are appended one after another and stay valid until
+ *          the arena is reset, no heap and no fragmentation. mark() and
+ *          reset(mark) free everything allocated after the mark at once,
+ *          e.g. all temporary strings of one loop cycle.
+ *          The free tail can be used as output of the other helpers:
+ *
+ *          size_t m = arena.mark();
+ *          const char *t = arena.commit(EspStrUtil::toChars(arena.tail(), arena.remaining(), 42));
+ *          const char *label = arena.copy("Boiler");
+ *          ...
+ *          arena.reset(m);
+ * *******************************************************************/
+class EspStrArena {
+
+protected:
+  char *buf;
+  size_t cap;      // buffer size
+  size_t used = 0; // bytes in use incl. the '\0' of every string
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   create arena on a caller buffer
+   * @param   buf   storage
+   * @param   size  size of storage
+   * *******************************************************************/
+  EspStrArena(char *buf, size_t size) : buf(buf), cap(buf ? size : 0) {}
+  EspStrArena(const EspStrArena &) = delete;
+  EspStrArena &operator=(const EspStrArena &) = delete;
+
+  /**
+   * *******************************************************************
+   * @brief   reserve uninitialized chars
+   * @param   n  number of chars
+   * @return  pointer to the chars or NULL if the arena is full
+   * *******************************************************************/
+  char *alloc(size_t n) {
+    if (n > cap - used)
+      return NULL;
+    char *p = buf + used;
+    used += n;
+    return p;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   copy string into the arena
+   * @param   str  string (may be not null terminated)
+   * @param   n    number of chars
+   * @return  null terminated copy or NULL if the arena is full
+   * *******************************************************************/
+  const char *copy(const char *str, size_t n) {
+    if (str == NULL)
+      return NULL;
+    char *p = alloc(n + 1);
+    if (p == NULL)
+      return NULL;
+    memcpy(p, str, n);
+    p[n] = '\0';
+    return p;
+  }
+
+  const char *copy(const char *str) { return str ? copy(str, strlen(str)) : NULL; }
+  const char *copy(EspStrView str) { return copy(str.data, str.len); }
+
+  /**
+   * *******************************************************************
+   * @brief   free space at the end, to be filled by a helper and then
+   *          committed, e.g. EspStrUtil::getIsoTimeString(tail(), remaining())
+   * @return  pointer to the free space
+   * *******************************************************************/
+  char *tail() { return buf + used; }
+  size_t remaining() const { return cap - used; }
+
+  /**
+   * *******************************************************************
+   * @brief   keep the string written into tail()
+   * @param   end  end pointer returned by the helper (NULL = failed)
+   * @return  the string or NULL if end is NULL
+   * *******************************************************************/
+  const char *commit(const char *end) {
+    if (end == NULL || end < tail() || end >= buf + cap)
+      return NULL;
+    const char *p = tail();
+    used = end - buf + 1; // keep the '\0'
+    return p;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   keep the string written into tail() by a helper that
+   *          returns the length, e.g. EspStrUtil::slugify()
+   * @param   len  length of the string written (without '\0')
+   * @return  the string or NULL if it does not fit
+   * *******************************************************************/
+  const char *commitLength(size_t len) { return remaining() > 0 ? commit(tail() + len) : NULL; }
+
+  /**
+   * *******************************************************************
+   * @brief   string builder on the free space, keep the result with
+   *          commit(span)
+   * @return  builder on tail()
+   * *******************************************************************/
+  EspStrSpan span() {
+    static char empty[1];
+    return remaining() > 0 ? EspStrSpan(tail(), remaining()) : EspStrSpan(empty, 1);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   keep the string of a builder created by span()
+   * @param   str  builder returned by span()
+   * @return  the string or NULL if it did not fit
+   * *******************************************************************/
+  const char *commit(const EspStrSpan &str) {
+    if (str.overflow() || str.c_str() != tail())
+      return NULL;
+    return commit(str.c_str() + str.length());
+  }
+
+  // current fill level, pass it to reset() to free everything allocated afterwards
+  size_t mark() const { return used; }
+  void reset(size_t mark = 0) {
+    if (mark < used)
+      used = mark;
+  }
+
+  size_t size() const { return used; }
+  size_t capacity() const { return cap; }
+};
+
+/**
+ * *******************************************************************
+ * @brief   string arena with its own storage of N bytes
+ * *******************************************************************/
+template <size_t N>
+class EspStrArenaBuffer : public EspStrArena {
+
+private:
+  char storage[N];
+
+public:
+  EspStrArenaBuffer() : EspStrArena(storage, N) {}
+};
+
+/**
+ * *******************************************************************
+ * @brief   handle of an interned string, 0 = invalid
+ *          equal strings of one pool always get the same handle, so
+ *          strings are compared by comparing handles
+ * *******************************************************************/
+typedef uint16_t EspStrHandle;
+
+/**
+ * *******************************************************************
+ * @brief   interning pool for repeated strings (topics, labels, ...)
+ *          every distinct string is stored once, up to SLOTS strings
+ *          with BYTES chars in total. The strings never move, views and
+ *          pointers stay valid until clear(). Lookup is a hash table
+ *          (xxHash32, open addressing), no heap.
+ *
+ *          EspStrPool<64, 2048> pool;
+ *          EspStrHandle h = pool.intern("boiler/temp");
+ *          if (h == pool.find(topic)) { ... }
+ *          Serial.println(pool.str(h));
+ * *******************************************************************/
+template <size_t SLOTS, size_t BYTES>
+class EspStrPool {
+
+  static_assert(SLOTS > 0 && SLOTS < 0xFFFF, "EspStrPool: SLOTS must be 1..65534");
+  static_assert(BYTES <= 0xFFFF, "EspStrPool: BYTES must be <= 65535");
+
+private:
+  static constexpr size_t tableSize() {
+    size_t n = 1;
+    while (n < SLOTS * 2)
+      n <<= 1;
+    return n;
+  }
+  static constexpr size_t TABLE = tableSize(); // load factor <= 0.5
+
+  char data[BYTES];
+  uint32_t hashes[SLOTS];
+  uint16_t offsets[SLOTS];
+  uint16_t lengths[SLOTS];
+  uint16_t table[TABLE] = {}; // handle or 0 = empty
+  size_t used = 0;
+  size_t count = 0;
+
+  // table position of the string or of the empty entry where it belongs
+  size_t lookup(const char *str, size_t len, uint32_t hash) const {
+    size_t pos = hash & (TABLE - 1);
+    while (table[pos] != 0) {
+      size_t slot = table[pos] - 1;
+      if (hashes[slot] == hash && lengths[slot] == len && memcmp(data + offsets[slot], str, len) == 0)
+        break;
+      pos = (pos + 1) & (TABLE - 1);
+    }
+    return pos;
+  }
+
+public:
+  EspStrPool() = default;
+  EspStrPool(const EspStrPool &) = delete;
+  EspStrPool &operator=(const EspStrPool &) = delete;
+
+  /**
+   * *******************************************************************
+   * @brief   get the handle of a string, add it if it is new
+   * @param   str  string (may be not null terminated)
+   * @param   len  length of string
+   * @return  handle or 0 if the pool is full
+   * *******************************************************************/
+  EspStrHandle intern(const char *str, size_t len) {
+    if (str == NULL)
+      return 0;
+    uint32_t hash = EspStrUtil::xxHash32(str, len);
+    size_t pos = lookup(str, len, hash);
+    if (table[pos] != 0)
+      return table[pos];
+    if (count >= SLOTS || len + 1 > BYTES - used)
+      return 0; // full
+    memcpy(data + used, str, len);
+    data[used + len] = '\0';
+    hashes[count] = hash;
+    offsets[count] = (uint16_t)used;
+    lengths[count] = (uint16_t)len;
+    used += len + 1;
+    table[pos] = (uint16_t)++count;
+    return table[pos];
+  }
+
+  EspStrHandle intern(const char *str) { return str ? intern(str, strlen(str)) : 0; }
+  EspStrHandle intern(EspStrView str) { return intern(str.data, str.len); }
+
+  /**
+   * *******************************************************************
+   * @brief   get the handle of a string without adding it
+   * @param   str  string (may be not null terminated)
+   * @param   len  length of string
+   * @return  handle or 0 if the string is not in the pool
+   * *******************************************************************/
+  EspStrHandle find(const char *str, size_t len) const {
+    if (str == NULL)
+      return 0;
+    return table[lookup(str, len, EspStrUtil::xxHash32(str, len))];
+  }
+
+  EspStrHandle find(const char *str) const { return str ? find(str, strlen(str)) : 0; }
+  EspStrHandle find(EspStrView str) const { return find(str.data, str.len); }
+
+  /**
+   * *******************************************************************
+   * @brief   get the string of a handle
+   * @param   h  handle
+   * @return  null terminated string, "" for invalid handles
+   * *******************************************************************/
+  const char *str(EspStrHandle h) const { return valid(h) ? data + offsets[h - 1] : ""; }
+  EspStrView view(EspStrHandle h) const { return valid(h) ? EspStrView{data + offsets[h - 1], lengths[h - 1]} : EspStrView{"", 0}; }
+  uint32_t hash(EspStrHandle h) const { return valid(h) ? hashes[h - 1] : 0; }
+  bool valid(EspStrHandle h) const { return h != 0 && h <= count; }
+
+  // remove all strings, all handles become invalid
+  void clear() {
+    memset(table, 0, sizeof(table));
+    used = 0;
+    count = 0;
+  }
+
+  size_t size() const { return count; }
+  size_t capacity() const { return SLOTS; }
+  size_t bytesUsed() const { return used; }
+};
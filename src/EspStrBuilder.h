@@ -0,0 +1,198 @@
+#pragma once
+
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   string builder on a caller buffer
+ *          keeps track of the length, so appending never rescans the
+ *          buffer like strcat. The content is always null terminated.
+ *          If something does not fit, the sticky overflow flag is set:
+ *          strings are truncated, numbers are skipped completely.
+ * *******************************************************************/
+class EspStrSpan {
+
+protected:
+  char *buf;
+  size_t cap; // buffer size incl. '\0'
+  size_t len = 0;
+  bool overflowed = false;
+
+  // called after a number was written with one of the toChars functions
+  EspStrSpan &commit(char *end) {
+    if (end == NULL) {
+      overflowed = true;
+      buf[len] = '\0';
+    } else {
+      len = end - buf;
+    }
+    return *this;
+  }
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   create builder on a caller buffer
+   * @param   buf   destination buffer
+   * @param   size  size of destination buffer (incl. '\0'), must be > 0
+   * *******************************************************************/
+  EspStrSpan(char *buf, size_t size) : buf(buf), cap(size) { buf[0] = '\0'; }
+  EspStrSpan(const EspStrSpan &) = delete;
+  EspStrSpan &operator=(const EspStrSpan &) = delete;
+
+  /**
+   * *******************************************************************
+   * @brief   append string with known length
+   * @param   str  string to append (may be not null terminated)
+   * @param   n    number of chars
+   * @return  reference to this builder
+   * *******************************************************************/
+  EspStrSpan &append(const char *str, size_t n) {
+    if (str == NULL)
+      return *this;
+    size_t space = cap - 1 - len;
+    if (n > space) {
+      n = space;
+      overflowed = true;
+    }
+    memcpy(buf + len, str, n);
+    len += n;
+    buf[len] = '\0';
+    return *this;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   append string
+   * @param   str  null terminated string
+   * @return  reference to this builder
+   * *******************************************************************/
+  EspStrSpan &append(const char *str) { return str ? append(str, strlen(str)) : *this; }
+
+  /**
+   * *******************************************************************
+   * @brief   append string view
+   * @param   str  string view
+   * @return  reference to this builder
+   * *******************************************************************/
+  EspStrSpan &append(EspStrView str) { return append(str.data, str.len); }
+
+  /**
+   * *******************************************************************
+   * @brief   append single char
+   * @param   c  char to append
+   * @return  reference to this builder
+   * *******************************************************************/
+  EspStrSpan &append(char c) {
+    if (len + 1 < cap) {
+      buf[len++] = c;
+      buf[len] = '\0';
+    } else {
+      overflowed = true;
+    }
+    return *this;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   append integer as decimal number
+   * @param   value  any 8/16/32/64-bit signed or unsigned integer
+   * @return  reference to this builder
+   * *******************************************************************/
+  template <typename T>
+  EspStrSpan &appendInt(T value) {
+    return commit(EspStrUtil::toChars(buf + len, cap - len, value));
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   append float or double as fixed-point number
+   * @param   value     float or double value
+   * @param   decimals  decimal precision
+   * @return  reference to this builder
+   * *******************************************************************/
+  template <typename T>
+  EspStrSpan &appendFloat(T value, int decimals = 1) {
+    return commit(EspStrUtil::floatToChars(buf + len, cap - len, value, decimals));
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   append unsigned integer as hex number
+   * @param   value   unsigned integer
+   * @param   digits  min. number of digits (leading zeros)
+   * @param   upper   use upper case letters
+   * @return  reference to this builder
+   * *******************************************************************/
+  template <typename T>
+  EspStrSpan &appendHex(T value, int digits = 0, bool upper = true) {
+    static_assert(std::is_integral<T>::value, "appendHex requires an integer type");
+    typedef typename std::make_unsigned<T>::type U;
+    const char *hexChars = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char tmp[sizeof(U) * 2];
+    char *end = tmp + sizeof(tmp);
+    char *start = end;
+    U v = (U)value;
+    do {
+      *--start = hexChars[v & 0xF];
+      v >>= 4;
+    } while (v != 0 && start > tmp);
+    while (end - start < digits && start > tmp) {
+      *--start = '0';
+    }
+    if ((size_t)(end - start) >= cap - len) {
+      overflowed = true;
+      return *this;
+    }
+    return append(start, end - start);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   reset to empty string, also clears the overflow flag
+   * @return  none
+   * *******************************************************************/
+  void clear() {
+    len = 0;
+    overflowed = false;
+    buf[0] = '\0';
+  }
+
+  const char *c_str() const { return buf; }
+  size_t length() const { return len; }
+  size_t capacity() const { return cap - 1; }
+  size_t remaining() const { return cap - 1 - len; }
+  bool overflow() const { return overflowed; }
+  EspStrView view() const { return {buf, len}; }
+
+  /**
+   * *******************************************************************
+   * @brief   EspStreamSink that appends to the EspStrSpan passed as ctx,
+   *          e.g. json(chunk, sizeof(chunk), EspStrSpan::sink, &out)
+   * @param   data  output chunk
+   * @param   len   length of output chunk
+   * @param   ctx   pointer to the EspStrSpan
+   * @return  false if the builder overflowed (stops the producer)
+   * *******************************************************************/
+  static bool sink(const char *data, size_t len, void *ctx) {
+    EspStrSpan *out = (EspStrSpan *)ctx;
+    out->append(data, len);
+    return !out->overflow();
+  }
+};
+
+/**
+ * *******************************************************************
+ * @brief   string builder with own fixed-capacity buffer of N bytes
+ *          (incl. '\0'), e.g. EspStrBuilder<512> html;
+ * *******************************************************************/
+template <size_t N>
+class EspStrBuilder : public EspStrSpan {
+  static_assert(N > 0, "EspStrBuilder needs a size > 0");
+
+private:
+  char storage[N];
+
+public:
+  EspStrBuilder() : EspStrSpan(storage, N) {}
+};
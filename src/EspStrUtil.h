@@ -1,18 +1,449 @@
 #pragma once
 
+// constexpr tables and parsers, inline static members, guaranteed copy elision
+#if __cplusplus < 201703L
+#error "EspStrUtil requires C++17 or newer (-std=gnu++17)"
+#endif
+
+#if defined(ARDUINO)
 #include <Arduino.h>
+#endif
 #include <cctype>
+#include <cmath>
 #include <cstring>
+#include <limits>
 #include <mbedtls/aes.h>
-#include <mbedtls/base64.h>
+#include <mbedtls/gcm.h>
+#include <mbedtls/platform_util.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <type_traits>
+
+#if defined(ESP_PLATFORM)
+#include <esp_random.h>
+#else
+#include <sys/random.h> // host build: getentropy()
+#endif
+
+#if defined(ESP_STR_UTIL_PROFILE)
+#include <atomic>
+#endif
+#if defined(ESP_STR_UTIL_PROFILE) && defined(ESP_PLATFORM)
+#include <esp_cpu.h>
+#include <freertos/FreeRTOS.h>
+#include <soc/soc_caps.h>
+#endif
+
+#if !defined(ARDUINO) && defined(__SSE2__)
+#include <emmintrin.h>
+#define ESP_STR_UTIL_SSE2
+#elif !defined(ARDUINO) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ESP_STR_UTIL_NEON
+#endif
+
+/**
+ * *******************************************************************
+ * @brief   callback to receive streamed output
+ * @param   data  output chunk (not null terminated)
+ * @param   len   length of output chunk
+ * @param   ctx   user context pointer given to init()
+ * @return  true to continue, false to abort the stream
+ * *******************************************************************/
+typedef bool (*EspStreamSink)(const char *data, size_t len, void *ctx);
+
+/**
+ * *******************************************************************
+ * @brief   non-owning string view (pointer + length, not null terminated)
+ * *******************************************************************/
+struct EspStrView {
+  const char *data;
+  size_t len;
+};
+
+/**
+ * *******************************************************************
+ * @brief   fixed size binary data, e.g. from EspStrUtil::hexLiteral()
+ * *******************************************************************/
+template <size_t N>
+struct EspBytes {
+  uint8_t data[N];
+  constexpr size_t size() const { return N; }
+  constexpr uint8_t operator[](size_t i) const { return data[i]; }
+};
+
+/**
+ * *******************************************************************
+ * @brief   result of the parse functions (like std::from_chars_result)
+ *          ptr points to the first character not parsed
+ * *******************************************************************/
+enum class EspParseError : uint8_t { Ok, Invalid, Overflow };
+
+struct EspParseResult {
+  const char *ptr;
+  EspParseError ec;
+  explicit operator bool() const { return ec == EspParseError::Ok; }
+};
+
+/**
+ * *******************************************************************
+ * @brief   build date/time, see EspStrUtil::getBuildInfo()
+ * *******************************************************************/
+struct EspBuildInfo {
+  uint16_t year;
+  uint8_t month; // 1..12
+  uint8_t day;
+  uint8_t hour;
+  uint8_t minute;
+  uint8_t second;
+  uint32_t epoch;    // seconds since 1970-01-01 (build time taken as UTC)
+  char dateTime[22]; // "DD.MM.YYYY - HH:MM:SS"
+};
+
+/**
+ * *******************************************************************
+ * @brief   version number "major.minor.patch", usable at compile time
+ *          constexpr EspVersion fw = EspVersion::parse("1.2.3");
+ * *******************************************************************/
+struct EspVersion {
+  uint8_t major;
+  uint8_t minor;
+  uint8_t patch;
+
+  // parse "1.2.3" or "v1.2.3", missing parts are 0
+  static constexpr EspVersion parse(const char *str) {
+    uint8_t parts[3] = {0, 0, 0};
+    int idx = 0;
+    if (str && (*str == 'v' || *str == 'V'))
+      str++;
+    for (; str && *str && idx < 3; str++) {
+      if (*str == '.') {
+        idx++;
+      } else if (*str >= '0' && *str <= '9') {
+        parts[idx] = (uint8_t)(parts[idx] * 10 + (*str - '0'));
+      } else {
+        break;
+      }
+    }
+    return EspVersion{parts[0], parts[1], parts[2]};
+  }
+
+  // single number for comparison: 0x00MMmmpp
+  constexpr uint32_t toInt() const { return ((uint32_t)major << 16) | ((uint32_t)minor << 8) | patch; }
+  constexpr bool operator==(const EspVersion &o) const { return toInt() == o.toInt(); }
+  constexpr bool operator!=(const EspVersion &o) const { return toInt() != o.toInt(); }
+  constexpr bool operator<(const EspVersion &o) const { return toInt() < o.toInt(); }
+  constexpr bool operator>=(const EspVersion &o) const { return toInt() >= o.toInt(); }
+};
+
+/**
+ * *******************************************************************
+ * @brief   opt-in instrumentation of the EspStrUtil functions
+ *          build with -DESP_STR_UTIL_PROFILE to count calls, cycles and
+ *          input bytes per function group, see EspProfile.h for reset
+ *          and report. Without the flag the hooks compile to nothing.
+ * *******************************************************************/
+enum class EspProfileId : uint8_t {
+  ToChars,      // toChars(), intToString()
+  FloatToChars, // floatToChars(), floatToString()
+  Encrypt,      // encryptPassword(), EspCipher::encrypt()
+  Decrypt,      // decryptPassword(), EspCipher::decrypt()
+  EncryptSecret,
+  DecryptSecret,
+  Base64Encode,
+  Base64Decode,
+  DateTime,  // get*String()
+  Hash,      // strHash(), strDiff(), xxHash32() at runtime
+  Transform, // to_lowercase(), replace_*(), transform(), slugify() ...
+  Parse,     // parseInt(), parseFloat(), parseBool(), isNumber()
+  Format,    // formatBytes(), formatSize(), formatDuration(), formatRate()
+  StrCat,
+  Count
+};
+
+struct EspProfileCounter {
+  uint32_t calls;
+  uint32_t maxCycles;
+  uint64_t cycles;
+  uint64_t bytes;
+};
+
+// clock for the profiler, returns cycles (ESP32) or any other time unit
+typedef uint32_t (*EspProfileClock)();
+
+#if defined(ESP_STR_UTIL_PROFILE)
+struct EspProfileData {
+#if defined(ESP_PLATFORM)
+  static constexpr int CORES = SOC_CPU_CORES_NUM;
+  static uint32_t defaultClock() { return (uint32_t)esp_cpu_get_cycle_count(); }
+  static int core() { return esp_cpu_get_core_id(); }
+#else
+  static constexpr int CORES = 1;
+  static uint32_t defaultClock() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec); // ns
+  }
+  static int core() { return 0; }
+#endif
+
+  // 64-bit value as two 32-bit halves: 32-bit loads and stores are plain
+  // instructions, 64-bit atomics would take the libatomic lock on the ESP32
+  struct Counter64 {
+    std::atomic<uint32_t> low;
+    std::atomic<uint32_t> high;
+
+    uint64_t load() const {
+      return ((uint64_t)high.load(std::memory_order_relaxed) << 32) | low.load(std::memory_order_relaxed);
+    }
+    void store(uint64_t value) { // only by the owner of the table
+      low.store((uint32_t)value, std::memory_order_relaxed);
+      high.store((uint32_t)(value >> 32), std::memory_order_relaxed);
+    }
+    void add(uint64_t n) { store(load() + n); }
+  };
+
+  // counters of one function group
+  struct Slot {
+    std::atomic<uint32_t> calls;
+    std::atomic<uint32_t> maxCycles;
+    Counter64 cycles;
+    Counter64 bytes;
+  };
+
+  // one table per core, only written by its own core inside Critical, so
+  // the cores never lock each other. Readers retry while sequence is odd or
+  // has changed. A table with an old generation counts as cleared.
+  struct Table {
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> generation;
+    Slot slots[(size_t)EspProfileId::Count];
+  };
+
+  Table tables[CORES];
+  std::atomic<uint32_t> generation; // incremented by reset()
+  std::atomic<EspProfileClock> clock{defaultClock};
+#if !defined(ESP_PLATFORM)
+  std::atomic_flag lock = ATOMIC_FLAG_INIT; // host threads share one table
+#endif
+
+  static EspProfileData &get() {
+    static EspProfileData data; // constant initialized, no guard
+    return data;
+  }
+
+  // ESP32: interrupts off on this core, so the task is neither preempted
+  // nor moved to the other core while it updates the table
+  struct Critical {
+#if defined(ESP_PLATFORM)
+    UBaseType_t state;
+    Critical() : state(portSET_INTERRUPT_MASK_FROM_ISR()) {}
+    ~Critical() { portCLEAR_INTERRUPT_MASK_FROM_ISR(state); }
+#else
+    Critical() {
+      while (get().lock.test_and_set(std::memory_order_acquire)) {
+      }
+    }
+    ~Critical() { get().lock.clear(std::memory_order_release); }
+#endif
+  };
+
+  // nesting depth of the profiled calls of the current task, only the
+  // outermost call is counted (its cycles include the nested calls)
+  static uint8_t &depth() {
+    static thread_local uint8_t value = 0;
+    return value;
+  }
+
+  void add(EspProfileId id, uint32_t elapsed, size_t n) {
+    Critical critical;
+    Table &t = tables[core()];
+    uint32_t seq = t.sequence.load(std::memory_order_relaxed);
+    t.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    uint32_t gen = generation.load(std::memory_order_relaxed);
+    if (t.generation.load(std::memory_order_relaxed) != gen) {
+      for (Slot &c : t.slots) {
+        c.calls.store(0, std::memory_order_relaxed);
+        c.maxCycles.store(0, std::memory_order_relaxed);
+        c.cycles.store(0);
+        c.bytes.store(0);
+      }
+      t.generation.store(gen, std::memory_order_relaxed);
+    }
+    Slot &c = t.slots[(size_t)id];
+    c.calls.store(c.calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    c.cycles.add(elapsed);
+    c.bytes.add(n);
+    if (elapsed > c.maxCycles.load(std::memory_order_relaxed))
+      c.maxCycles.store(elapsed, std::memory_order_relaxed);
+    t.sequence.store(seq + 2, std::memory_order_release);
+  }
+
+  // consistent copy of the counters of one core
+  EspProfileCounter read(int core, EspProfileId id) const {
+    const Table &t = tables[core];
+    const Slot &c = t.slots[(size_t)id];
+    EspProfileCounter copy;
+    uint32_t seq;
+    do {
+      seq = t.sequence.load(std::memory_order_acquire);
+      copy = {};
+      if (t.generation.load(std::memory_order_relaxed) == generation.load(std::memory_order_relaxed)) {
+        copy.calls = c.calls.load(std::memory_order_relaxed);
+        copy.maxCycles = c.maxCycles.load(std::memory_order_relaxed);
+        copy.cycles = c.cycles.load();
+        copy.bytes = c.bytes.load();
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || t.sequence.load(std::memory_order_relaxed) != seq);
+    return copy;
+  }
+};
+
+class EspProfileScope {
+  EspProfileId id;
+  bool outer;
+  uint32_t start = 0;
+  size_t bytes;
+
+public:
+  EspProfileScope(EspProfileId id, size_t bytes) : id(id), outer(EspProfileData::depth()++ == 0), bytes(bytes) {
+    if (outer)
+      start = EspProfileData::get().clock.load(std::memory_order_relaxed)();
+  }
+  ~EspProfileScope() {
+    if (outer) {
+      EspProfileData &data = EspProfileData::get();
+      uint32_t cycles = data.clock.load(std::memory_order_relaxed)() - start;
+      data.add(id, cycles, bytes);
+    }
+    EspProfileData::depth()--;
+  }
+  EspProfileScope(const EspProfileScope &) = delete;
+  EspProfileScope &operator=(const EspProfileScope &) = delete;
+};
+
+#define ESP_STR_PROFILE(id, bytes) EspProfileScope espProfileScope(EspProfileId::id, (bytes))
+#else
+#define ESP_STR_PROFILE(id, bytes)
+#endif
+
+/**
+ * *******************************************************************
+ * @brief   result buffer of the functions that return local static memory
+ *          build with -DESP_STR_UTIL_THREAD_SAFE to give every task its own
+ *          ring of ESP_STR_UTIL_RING_SLOTS buffers (thread_local, 64 bytes
+ *          each): calls from several tasks/cores and up to RING_SLOTS calls
+ *          in one expression are safe without a mutex. Default: one shared
+ *          static buffer per function.
+ *          On ESP-IDF the thread_local storage is reserved on the stack of
+ *          every FreeRTOS task (also system, IPC and timer tasks), whether
+ *          the task uses the library or not: 64 * RING_SLOTS + 1 bytes per
+ *          task, plus the per-task clock cache (about 100 bytes).
+ * *******************************************************************/
+#if defined(ESP_STR_UTIL_THREAD_SAFE)
+#if !defined(ESP_STR_UTIL_RING_SLOTS)
+#define ESP_STR_UTIL_RING_SLOTS 4
+#endif
+#define ESP_STR_RESULT(name, size)                                                                                     \
+  static_assert((size) <= EspStrUtil::RESULT_SIZE, "result does not fit into a ring slot");                           \
+  char *const name = EspStrUtil::resultSlot()
+#else
+#define ESP_STR_RESULT(name, size) static char name[size]
+#endif
+
+/**
+ * *******************************************************************
+ * @brief   256-entry character map for EspStrUtil::transform()
+ *          every byte is replaced by its table entry, entries with '\0'
+ *          are removed from the output. Can be built at compile time:
+ *          constexpr EspCharMap map = EspCharMap().lower().set(' ', '_');
+ * *******************************************************************/
+class EspCharMap {
+
+private:
+  char table[256];
+
+public:
+  // identity map
+  constexpr EspCharMap() : table() {
+    for (int i = 0; i < 256; i++)
+      table[i] = (char)i;
+  }
+
+  // replace character "from" with "to"
+  constexpr EspCharMap &set(char from, char to) {
+    if (from != '\0')
+      table[(unsigned char)from] = to;
+    return *this;
+  }
+
+  // replace every character of "chars" with "to"
+  constexpr EspCharMap &set(const char *chars, char to) {
+    for (; chars && *chars; chars++)
+      set(*chars, to);
+    return *this;
+  }
+
+  // remove character(s) from the output
+  constexpr EspCharMap &drop(char c) { return set(c, '\0'); }
+  constexpr EspCharMap &drop(const char *chars) { return set(chars, '\0'); }
+
+  // ASCII case mapping
+  constexpr EspCharMap &lower() {
+    for (int c = 'A'; c <= 'Z'; c++)
+      table[c] = (char)(c + 32);
+    return *this;
+  }
+  constexpr EspCharMap &upper() {
+    for (int c = 'a'; c <= 'z'; c++)
+      table[c] = (char)(c - 32);
+    return *this;
+  }
+
+  constexpr char operator[](unsigned char c) const { return table[c]; }
+};
 
 class EspStrUtil {
 
+  friend class EspAesDecryptor;
+  friend class EspAesEncryptor;
+  friend class EspCipher;
+  friend class EspXxHash32;
+
 private:
   static constexpr size_t AES_BLOCK_SIZE = 16;
+  static constexpr size_t RESULT_SIZE = 64; // largest result of the static-buffer API, see ESP_STR_RESULT
+
+#if defined(ESP_STR_UTIL_THREAD_SAFE)
+  static_assert(ESP_STR_UTIL_RING_SLOTS > 0 && ESP_STR_UTIL_RING_SLOTS <= 255, "ESP_STR_UTIL_RING_SLOTS must be 1..255");
+
+  // next buffer of the ring of the calling task
+  static char *resultSlot() {
+    static thread_local char ring[ESP_STR_UTIL_RING_SLOTS][RESULT_SIZE];
+    static thread_local uint8_t next = 0;
+    char *slot = ring[next];
+    next = (uint8_t)(next + 1 < ESP_STR_UTIL_RING_SLOTS ? next + 1 : 0);
+    return slot;
+  }
+#endif
+
+  // zeroizes a stack buffer on every return path
+  class ZeroizeOnExit {
+    void *buf;
+    size_t len;
+
+  public:
+    ZeroizeOnExit(void *buf, size_t len) : buf(buf), len(len) {}
+    ~ZeroizeOnExit() { mbedtls_platform_zeroize(buf, len); }
+    ZeroizeOnExit(const ZeroizeOnExit &) = delete;
+    ZeroizeOnExit &operator=(const ZeroizeOnExit &) = delete;
+  };
 
   // add PKCS7-Padding
   static size_t addPadding(unsigned char *buffer, size_t dataLength,
@@ -37,24 +468,14 @@ private:
     return dataLength - paddingLength;
   }
 
-public:
-  /**
-   * *******************************************************************
-   * @brief   Encrypts a password and encodes it in Base64 format
-   * @param   input         Plaintext password to be encrypted
-   * @param   key           16-byte AES key used for encryption
-   * @param   output        Buffer to store the Base64-encoded, encrypted
-   * password
-   * @param   maxOutputSize Maximum size of the output buffer
-   * @return  true if encryption and Base64 encoding is successful
-   * *******************************************************************/
-  static bool encryptPassword(const char *input, const unsigned char *key,
-                              char *output, size_t maxOutputSize) {
-    if (!input || !key || !output || maxOutputSize == 0)
-      return false;
-
+  // encrypt with an already keyed AES context (see encryptPassword)
+  static bool encryptWithContext(mbedtls_aes_context *aes, const char *input,
+                                 char *output, size_t maxOutputSize) {
+    ESP_STR_PROFILE(Encrypt, strlen(input));
     unsigned char paddedInput[128 + AES_BLOCK_SIZE] = {0};
     unsigned char encrypted[128 + AES_BLOCK_SIZE] = {0};
+    ZeroizeOnExit wipePlain(paddedInput, sizeof(paddedInput));
+    ZeroizeOnExit wipeEncrypted(encrypted, sizeof(encrypted));
 
     size_t inputLength = strlen(input);
     if (inputLength > 128)
@@ -66,26 +487,727 @@ public:
     if (paddedLength == 0)
       return false; // Padding-error
 
-    mbedtls_aes_context aes;
-    mbedtls_aes_init(&aes);
-    mbedtls_aes_setkey_enc(&aes, key, 128);
-
     for (size_t i = 0; i < paddedLength; i += AES_BLOCK_SIZE) {
-      mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, paddedInput + i,
+      mbedtls_aes_crypt_ecb(aes, MBEDTLS_AES_ENCRYPT, paddedInput + i,
                             encrypted + i);
     }
-    mbedtls_aes_free(&aes);
 
-    size_t base64Length = 0;
-    if (mbedtls_base64_encode((unsigned char *)output, maxOutputSize,
-                              &base64Length, encrypted, paddedLength) != 0) {
+    return base64Encode(output, maxOutputSize, encrypted, paddedLength) != NULL;
+  }
+
+  // decrypt with an already keyed AES context (see decryptPassword)
+  static bool decryptWithContext(mbedtls_aes_context *aes, const char *input,
+                                 char *output, size_t maxOutputSize) {
+    ESP_STR_PROFILE(Decrypt, strlen(input));
+    unsigned char encrypted[128 + AES_BLOCK_SIZE] = {0};
+    ZeroizeOnExit wipeEncrypted(encrypted, sizeof(encrypted));
+
+    size_t encryptedLength = 0;
+    if (!base64Decode(encrypted, sizeof(encrypted), input, strlen(input),
+                      &encryptedLength)) {
+      return false; // error Base64-decoding
+    }
+    return decryptBlocks(aes, encrypted, encryptedLength, output, maxOutputSize);
+  }
+
+  // decrypt raw AES-ECB blocks and remove the PKCS7-Padding
+  static bool decryptBlocks(mbedtls_aes_context *aes, const unsigned char *encrypted,
+                            size_t encryptedLength, char *output, size_t maxOutputSize) {
+    unsigned char decrypted[128 + AES_BLOCK_SIZE] = {0};
+    ZeroizeOnExit wipeDecrypted(decrypted, sizeof(decrypted));
+    if (encryptedLength > sizeof(decrypted)) {
+      return false; // error: invalid length
+    }
+
+    for (size_t i = 0; i < encryptedLength; i += AES_BLOCK_SIZE) {
+      mbedtls_aes_crypt_ecb(aes, MBEDTLS_AES_DECRYPT, encrypted + i,
+                            decrypted + i);
+    }
+
+    size_t actualLength = removePadding(decrypted, encryptedLength);
+    if (actualLength == 0 || actualLength >= maxOutputSize) {
+      return false; // error
+    }
+
+    memcpy(output, decrypted, actualLength);
+    output[actualLength] = '\0';
+    return true;
+  }
+
+  // envelope format of encryptSecret(): "$2$" + Base64(nonce | ciphertext | tag)
+  // '$' is not a Base64 char, so an envelope can never be read as a legacy
+  // encryptPassword() blob (format 1) and vice versa
+  static constexpr char SECRET_PREFIX[] = "$2$";
+  static constexpr size_t SECRET_PREFIX_LENGTH = sizeof(SECRET_PREFIX) - 1;
+  static constexpr size_t SECRET_NONCE_SIZE = 12;
+  static constexpr size_t SECRET_TAG_SIZE = 16;
+  static constexpr size_t SECRET_OVERHEAD = SECRET_NONCE_SIZE + SECRET_TAG_SIZE;
+  static constexpr size_t MAX_SECRET_LENGTH = 128;
+
+  // random bytes from the hardware RNG (ESP32) or the OS (host build)
+  static inline void fillRandom(void *buf, size_t len) {
+#if defined(ESP_PLATFORM)
+    esp_fill_random(buf, len);
+#else
+    if (getentropy(buf, len) != 0)
+      abort(); // never encrypt with a predictable nonce
+#endif
+  }
+
+  // encrypt with an already keyed GCM context (see encryptSecret)
+  static bool encryptSecretWithContext(mbedtls_gcm_context *gcm, const char *input,
+                                       char *output, size_t maxOutputSize) {
+    ESP_STR_PROFILE(EncryptSecret, strlen(input));
+    unsigned char envelope[SECRET_OVERHEAD + MAX_SECRET_LENGTH];
+    ZeroizeOnExit wipeEnvelope(envelope, sizeof(envelope));
+
+    size_t inputLength = strlen(input);
+    if (inputLength > MAX_SECRET_LENGTH)
+      return false; // Secret to long
+
+    unsigned char *nonce = envelope;
+    unsigned char *encrypted = nonce + SECRET_NONCE_SIZE;
+    unsigned char *tag = encrypted + inputLength;
+    fillRandom(nonce, SECRET_NONCE_SIZE);
+
+    // the prefix is authenticated as additional data
+    if (mbedtls_gcm_crypt_and_tag(gcm, MBEDTLS_GCM_ENCRYPT, inputLength, nonce,
+                                  SECRET_NONCE_SIZE, (const unsigned char *)SECRET_PREFIX,
+                                  SECRET_PREFIX_LENGTH, (const unsigned char *)input,
+                                  encrypted, SECRET_TAG_SIZE, tag) != 0) {
       return false;
     }
 
-    output[base64Length] = '\0';
+    if (maxOutputSize <= SECRET_PREFIX_LENGTH)
+      return false; // buffer to small
+    memcpy(output, SECRET_PREFIX, SECRET_PREFIX_LENGTH);
+    return base64Encode(output + SECRET_PREFIX_LENGTH, maxOutputSize - SECRET_PREFIX_LENGTH,
+                        envelope, SECRET_OVERHEAD + inputLength) != NULL;
+  }
+
+  // decrypt with an already keyed GCM context (see decryptSecret)
+  // legacyAes is keyed with legacyKey only if needed (legacyKey may be NULL)
+  static bool decryptSecretWithContext(mbedtls_gcm_context *gcm,
+                                       mbedtls_aes_context *legacyAes,
+                                       const unsigned char *legacyKey,
+                                       const char *input, char *output,
+                                       size_t maxOutputSize, bool *legacy) {
+    ESP_STR_PROFILE(DecryptSecret, strlen(input));
+    unsigned char envelope[SECRET_OVERHEAD + MAX_SECRET_LENGTH];
+    unsigned char decrypted[MAX_SECRET_LENGTH];
+    ZeroizeOnExit wipeEnvelope(envelope, sizeof(envelope));
+    ZeroizeOnExit wipeDecrypted(decrypted, sizeof(decrypted));
+
+    size_t inputLength = strlen(input);
+    size_t envelopeLength = 0;
+    if (strncmp(input, SECRET_PREFIX, SECRET_PREFIX_LENGTH) == 0) {
+      // an authenticated envelope: no fallback to the legacy format, a
+      // tampered envelope must never be accepted as legacy password
+      if (!base64Decode(envelope, sizeof(envelope), input + SECRET_PREFIX_LENGTH,
+                        inputLength - SECRET_PREFIX_LENGTH, &envelopeLength) ||
+          envelopeLength < SECRET_OVERHEAD) {
+        return false; // error Base64-decoding or envelope to short
+      }
+      size_t length = envelopeLength - SECRET_OVERHEAD;
+      const unsigned char *nonce = envelope;
+      const unsigned char *encrypted = nonce + SECRET_NONCE_SIZE;
+      if (length >= maxOutputSize ||
+          mbedtls_gcm_auth_decrypt(gcm, length, nonce, SECRET_NONCE_SIZE,
+                                   (const unsigned char *)SECRET_PREFIX, SECRET_PREFIX_LENGTH,
+                                   encrypted + length, SECRET_TAG_SIZE, encrypted,
+                                   decrypted) != 0) {
+        return false; // buffer to small or authentication failed
+      }
+      memcpy(output, decrypted, length);
+      output[length] = '\0';
+      if (legacy)
+        *legacy = false;
+      return true;
+    }
+
+    // no prefix: legacy AES-ECB format of encryptPassword()
+    if (!base64Decode(envelope, sizeof(envelope), input, inputLength, &envelopeLength)) {
+      return false; // error Base64-decoding
+    }
+    if (legacyKey && mbedtls_aes_setkey_dec(legacyAes, legacyKey, 128) != 0) {
+      return false;
+    }
+    if (!decryptBlocks(legacyAes, envelope, envelopeLength, output, maxOutputSize)) {
+      return false;
+    }
+    if (legacy)
+      *legacy = true;
     return true;
   }
 
+  // Base64 alphabets (RFC 4648), decoding accepts both
+  static constexpr char BASE64_CHARS[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  static constexpr char BASE64URL_CHARS[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+  // Base64 decoding table, invalid chars have the high bit set
+  static constexpr uint8_t B64X = 0xFF;
+  static constexpr uint8_t BASE64_DECODE[256] = {
+      B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+      B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+      B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, 62, B64X, 62, B64X, 63,
+      52, 53, 54, 55, 56, 57, 58, 59, 60, 61, B64X, B64X, B64X, B64X, B64X, B64X,
+      B64X, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+      15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, B64X, B64X, B64X, B64X, 63,
+      B64X, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+      41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, B64X, B64X, B64X, B64X, B64X,
+      B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+      B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+      B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+      B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+      B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+      B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+      B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+      B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+  };
+
+  // hex digits and decoding table, invalid chars have the high bit set
+  static constexpr char HEX_UPPER[17] = "0123456789ABCDEF";
+  static constexpr char HEX_LOWER[17] = "0123456789abcdef";
+  static constexpr uint8_t HEXX = 0xFF;
+  static constexpr uint8_t HEX_DECODE[256] = {
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      0, 1, 2, 3, 4, 5, 6, 7, 8, 9, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, 10, 11, 12, 13, 14, 15, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, 10, 11, 12, 13, 14, 15, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+      HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX, HEXX,
+  };
+
+  static constexpr bool isHexSeparator(char c) { return c == ':' || c == '-' || c == ' '; }
+
+  // only called for invalid input: not constexpr, so a constexpr hexLiteral()
+  // fails to compile, at runtime it stops instead of returning a wrong key byte
+  static uint8_t invalidHexLiteral() {
+    abort();
+    return 0;
+  }
+
+  static constexpr uint8_t hexLiteralNibble(char c) {
+    return (c >= '0' && c <= '9')   ? (uint8_t)(c - '0')
+           : (c >= 'a' && c <= 'f') ? (uint8_t)(c - 'a' + 10)
+           : (c >= 'A' && c <= 'F') ? (uint8_t)(c - 'A' + 10)
+                                    : invalidHexLiteral();
+  }
+
+  // hash constants
+  static constexpr uint32_t XXH_PRIME1 = 0x9E3779B1u;
+  static constexpr uint32_t XXH_PRIME2 = 0x85EBCA77u;
+  static constexpr uint32_t XXH_PRIME3 = 0xC2B2AE3Du;
+  static constexpr uint32_t XXH_PRIME4 = 0x27D4EB2Fu;
+  static constexpr uint32_t XXH_PRIME5 = 0x165667B1u;
+  static constexpr uint32_t FNV32_OFFSET = 0x811C9DC5u;
+  static constexpr uint32_t FNV32_PRIME = 0x01000193u;
+  static constexpr uint64_t FNV64_OFFSET = 0xCBF29CE484222325ull;
+  static constexpr uint64_t FNV64_PRIME = 0x00000100000001B3ull;
+
+  static constexpr size_t constLength(const char *str) {
+    size_t len = 0;
+    while (str && str[len])
+      len++;
+    return len;
+  }
+
+  static constexpr uint32_t rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+  }
+
+  // little endian 32-bit read, works at compile time and unaligned
+  static constexpr uint32_t readLE32(const char *p) {
+    return (uint32_t)(uint8_t)p[0] | ((uint32_t)(uint8_t)p[1] << 8) |
+           ((uint32_t)(uint8_t)p[2] << 16) | ((uint32_t)(uint8_t)p[3] << 24);
+  }
+
+  static constexpr uint32_t xxhRound(uint32_t acc, uint32_t input) {
+    return rotl32(acc + input * XXH_PRIME2, 13) * XXH_PRIME1;
+  }
+
+  // process the tail (< 16 bytes) and mix the final hash
+  static constexpr uint32_t xxhFinalize(uint32_t h, const char *p, size_t len) {
+    for (; len >= 4; len -= 4, p += 4) {
+      h = rotl32(h + readLE32(p) * XXH_PRIME3, 17) * XXH_PRIME4;
+    }
+    for (; len > 0; len--, p++) {
+      h = rotl32(h + (uint8_t)*p * XXH_PRIME5, 11) * XXH_PRIME1;
+    }
+    h ^= h >> 15;
+    h *= XXH_PRIME2;
+    h ^= h >> 13;
+    h *= XXH_PRIME3;
+    h ^= h >> 16;
+    return h;
+  }
+
+  // max. number of chars for a 64-bit integer incl. sign
+  static constexpr size_t MAX_INT_DIGITS = 20;
+
+  // lookup table with all two digit pairs "00".."99"
+  static constexpr char DIGIT_PAIRS[201] = "00010203040506070809"
+                                           "10111213141516171819"
+                                           "20212223242526272829"
+                                           "30313233343536373839"
+                                           "40414243444546474849"
+                                           "50515253545556575859"
+                                           "60616263646566676869"
+                                           "70717273747576777879"
+                                           "80818283848586878889"
+                                           "90919293949596979899";
+
+  // write unsigned value backwards, ending before 'end', returns first char
+  static inline char *writeUnsigned32(char *end, uint32_t value) {
+    while (value >= 100) {
+      uint32_t idx = (value % 100) * 2;
+      value /= 100;
+      *--end = DIGIT_PAIRS[idx + 1];
+      *--end = DIGIT_PAIRS[idx];
+    }
+    if (value >= 10) {
+      *--end = DIGIT_PAIRS[value * 2 + 1];
+      *--end = DIGIT_PAIRS[value * 2];
+    } else {
+      *--end = (char)('0' + value);
+    }
+    return end;
+  }
+
+  // write exactly 'digits' chars (with leading zeros) backwards
+  static inline char *writeFixed32(char *end, uint32_t value, int digits) {
+    for (; digits >= 2; digits -= 2) {
+      uint32_t idx = (value % 100) * 2;
+      value /= 100;
+      *--end = DIGIT_PAIRS[idx + 1];
+      *--end = DIGIT_PAIRS[idx];
+    }
+    if (digits) {
+      *--end = (char)('0' + value % 10);
+    }
+    return end;
+  }
+
+  // fast path precision limit of floatToChars
+  static constexpr int MAX_FLOAT_DECIMALS = 6;
+
+  static constexpr uint32_t POW10[MAX_FLOAT_DECIMALS + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+  // 64-bit variant: split into 8-digit chunks to keep the divisions 32-bit
+  static inline char *writeUnsigned64(char *end, uint64_t value) {
+    while (value > UINT32_MAX) {
+      uint64_t upper = value / 100000000u;
+      end = writeFixed32(end, (uint32_t)(value - upper * 100000000u), 8);
+      value = upper;
+    }
+    return writeUnsigned32(end, (uint32_t)value);
+  }
+
+  // copy chars [start, end) into caller buffer, add '\0' and return end pointer
+  static inline char *copyOut(char *buf, size_t size, const char *start, const char *end) {
+    size_t len = end - start;
+    if (buf == NULL || len >= size)
+      return NULL; // error buffer to small
+    memcpy(buf, start, len);
+    buf[len] = '\0';
+    return buf + len;
+  }
+
+  // cached local time, rebuilt only if the second changes, localtime_r()
+  // is only called if the hour changes
+  struct ClockCache {
+    uint32_t generation = 0; // see invalidateClockCache()
+    time_t now = -1;   // cached second
+    time_t hourStart;  // first second of the cached hour
+    tm dti;            // broken-down local time
+    int32_t utcOffset; // seconds east of UTC
+    char date[11];     // "DD.MM.YYYY"
+    char dateWeb[11];  // "YYYY-MM-DD"
+    char time[9];      // "HH:MM:SS"
+  };
+
+  // write value 0..99 as two digits
+  static inline void put2(char *p, int value) {
+    p[0] = DIGIT_PAIRS[value * 2];
+    p[1] = DIGIT_PAIRS[value * 2 + 1];
+  }
+
+  // days since 1970-01-01 of a civil date (proleptic Gregorian calendar)
+  static constexpr int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+    y -= m <= 2;
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    uint32_t yoe = (uint32_t)(y - era * 400);
+    uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+  }
+
+  static volatile uint32_t &clockGeneration() {
+    static volatile uint32_t generation = 0;
+    return generation;
+  }
+
+  // one shared cache like the other static buffers, per task cache (no
+  // locking needed) only in the thread-safe build
+  static ClockCache &clockCache(time_t now) {
+#if defined(ESP_STR_UTIL_THREAD_SAFE)
+    static thread_local ClockCache c;
+#else
+    static ClockCache c;
+#endif
+    uint32_t generation = clockGeneration();
+    if (generation != c.generation) {
+      c.generation = generation;
+      c.now = -1; // full rebuild
+    }
+    if (now == c.now)
+      return c;
+
+    if (c.now >= 0 && now > c.now && now < c.hourStart + 3600) {
+      // same hour: derive minutes and seconds
+      int32_t secs = (int32_t)(now - c.hourStart);
+      c.dti.tm_min = secs / 60;
+      c.dti.tm_sec = secs % 60;
+    } else {
+      int lastDay = c.now >= 0 ? c.dti.tm_yday : -1;
+      int lastYear = c.dti.tm_year;
+      localtime_r(&now, &c.dti);
+      c.hourStart = now - c.dti.tm_min * 60 - c.dti.tm_sec;
+      int64_t local = (int64_t)daysFromCivil(c.dti.tm_year + 1900, c.dti.tm_mon + 1, c.dti.tm_mday) * 86400 +
+                      c.dti.tm_hour * 3600 + c.dti.tm_min * 60 + c.dti.tm_sec;
+      c.utcOffset = (int32_t)(local - (int64_t)now);
+      if (c.dti.tm_yday != lastDay || c.dti.tm_year != lastYear) {
+        int year = c.dti.tm_year + 1900;
+        put2(c.date, c.dti.tm_mday);
+        c.date[2] = '.';
+        put2(c.date + 3, c.dti.tm_mon + 1);
+        c.date[5] = '.';
+        put2(c.date + 6, (year / 100) % 100);
+        put2(c.date + 8, year % 100);
+        c.date[10] = '\0';
+        memcpy(c.dateWeb, c.date + 6, 4);
+        c.dateWeb[4] = '-';
+        memcpy(c.dateWeb + 5, c.date + 3, 2);
+        c.dateWeb[7] = '-';
+        memcpy(c.dateWeb + 8, c.date, 2);
+        c.dateWeb[10] = '\0';
+      }
+      put2(c.time, c.dti.tm_hour);
+      c.time[2] = ':';
+      c.time[5] = ':';
+      c.time[8] = '\0';
+    }
+    put2(c.time + 3, c.dti.tm_min);
+    put2(c.time + 6, c.dti.tm_sec);
+    c.now = now;
+    return c;
+  }
+
+  // fixed-point float formatting with scaled integers
+  template <typename T>
+  static char *formatFixed(char *buf, size_t size, T value, int decimals) {
+    ESP_STR_PROFILE(FloatToChars, sizeof(T));
+    if (buf == NULL || size == 0)
+      return NULL;
+    if (decimals < 0)
+      decimals = 0;
+
+    if (std::isnan(value)) {
+      return copyOut(buf, size, "nan", "nan" + 3);
+    }
+    if (std::isinf(value)) {
+      return value < 0 ? copyOut(buf, size, "-inf", "-inf" + 4) : copyOut(buf, size, "inf", "inf" + 3);
+    }
+
+    bool negative = std::signbit(value);
+    T absValue = negative ? -value : value;
+    // below this value the mantissa has bits under 2^-64, they are lost by
+    // the 0.64 fixed-point split and the rounding would not be exact
+    constexpr T minExact = (T)1 / (T)(1ull << (65 - std::numeric_limits<T>::digits));
+    if (decimals <= MAX_FLOAT_DECIMALS && absValue < minExact && absValue != 0) {
+      // tiny value: exact rounding by printf, no "-0" like the fast path
+      char tmp[MAX_FLOAT_DECIMALS + 4];
+      int len = snprintf(tmp + 1, sizeof(tmp) - 1, "%.*f", decimals, (double)absValue);
+      char *start = tmp + 1;
+      if (negative && strpbrk(start, "123456789") != NULL)
+        *--start = '-';
+      return copyOut(buf, size, start, tmp + 1 + len);
+    }
+    if (decimals > MAX_FLOAT_DECIMALS || absValue >= (T)1.8e19) {
+      // out of fast path range, use the generic formatter
+      int len = snprintf(buf, size, "%.*f", decimals, (double)value);
+      return (len < 0 || (size_t)len >= size) ? NULL : buf + len;
+    }
+
+    // split into integer and fractional part to keep full precision
+    uint64_t intPart = (uint64_t)absValue;
+    uint32_t scale = POW10[decimals];
+    // fraction as exact 0.64 fixed-point (two 32-bit steps), times scale as 96-bit product
+    T fracHigh = (absValue - (T)intPart) * (T)4294967296.0;
+    uint32_t highBits = (uint32_t)fracHigh;
+    T fracLow = (fracHigh - (T)highBits) * (T)4294967296.0;
+    uint32_t lowBits = (uint32_t)fracLow;
+    uint64_t productLow = (uint64_t)lowBits * scale;
+    uint64_t productHigh = (uint64_t)highBits * scale + (productLow >> 32);
+    uint32_t fracPart = (uint32_t)(productHigh >> 32);
+    uint64_t remainder = (productHigh << 32) | (uint32_t)productLow;
+    const uint64_t half = 1ull << 63;
+    if (remainder > half || (remainder == half && ((decimals ? fracPart : (uint32_t)intPart) & 1))) {
+      fracPart++; // round half to even, same as printf
+    }
+    if (fracPart >= scale) {
+      fracPart -= scale;
+      intPart++;
+    }
+    if (intPart == 0 && fracPart == 0) {
+      negative = false; // no "-0" for negative zero or values rounded to zero
+    }
+
+    char tmp[MAX_INT_DIGITS + MAX_FLOAT_DECIMALS + 2];
+    char *end = tmp + sizeof(tmp);
+    char *start = end;
+    if (decimals > 0) {
+      start = writeFixed32(start, fracPart, decimals);
+      *--start = '.';
+    }
+    start = writeUnsigned64(start, intPart);
+    if (negative) {
+      *--start = '-';
+    }
+    return copyOut(buf, size, start, end);
+  }
+
+  // SWAR: 4 chars per step, only ASCII bytes (bit 7 clear) are changed
+  static constexpr uint32_t SWAR_ONES = 0x01010101u;
+  static constexpr uint32_t SWAR_HIGH = 0x80808080u;
+
+  // toggle case (0x20) of all bytes in range lo..hi
+  static inline uint32_t swarFlipCase(uint32_t w, uint8_t lo, uint8_t hi) {
+    uint32_t ascii = w & 0x7F7F7F7Fu;
+    uint32_t geLo = ascii + (0x80u - lo) * SWAR_ONES;  // bit 7 set if >= lo
+    uint32_t gtHi = ascii + (0x7Fu - hi) * SWAR_ONES;  // bit 7 set if > hi
+    uint32_t mask = geLo & ~gtHi & ~w & SWAR_HIGH;
+    return w ^ (mask >> 2);
+  }
+
+  // replace all bytes "from" with "to"
+  static inline uint32_t swarReplace(uint32_t w, uint8_t from, uint8_t to) {
+    uint32_t x = w ^ (from * SWAR_ONES); // matching bytes are zero now
+    uint32_t zero = ~(((x & 0x7F7F7F7Fu) + 0x7F7F7F7Fu) | x) & SWAR_HIGH;
+    uint32_t mask = (zero >> 7) * 0xFFu;
+    return (w & ~mask) | (to * SWAR_ONES & mask);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   bulk kernel for case mapping (lo != 0) or replacing a char
+   *          input and output may be the same buffer
+   * @param   src   input chars
+   * @param   dst   output chars
+   * @param   len   number of chars
+   * @param   a     case: first char of range, replace: char to replace
+   * @param   b     case: last char of range, replace: replacement
+   * @param   flip  true: toggle case in range a..b, false: replace a by b
+   * *******************************************************************/
+  static inline void bulkKernel(const char *src, char *dst, size_t len, uint8_t a, uint8_t b, bool flip) {
+    size_t i = 0;
+#if defined(ESP_STR_UTIL_SSE2)
+    const __m128i va = _mm_set1_epi8((char)a);
+    const __m128i vb = _mm_set1_epi8((char)b);
+    for (; i + 16 <= len; i += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+      __m128i r;
+      if (flip) {
+        // signed compare: bytes >= 0x80 are negative and never in range
+        __m128i in = _mm_andnot_si128(_mm_or_si128(_mm_cmplt_epi8(v, va), _mm_cmpgt_epi8(v, vb)),
+                                      _mm_set1_epi8(0x20));
+        r = _mm_xor_si128(v, in);
+      } else {
+        __m128i eq = _mm_cmpeq_epi8(v, va);
+        r = _mm_or_si128(_mm_andnot_si128(eq, v), _mm_and_si128(eq, vb));
+      }
+      _mm_storeu_si128((__m128i *)(dst + i), r);
+    }
+#elif defined(ESP_STR_UTIL_NEON)
+    const uint8x16_t va = vdupq_n_u8(a);
+    const uint8x16_t vb = vdupq_n_u8(b);
+    for (; i + 16 <= len; i += 16) {
+      uint8x16_t v = vld1q_u8((const uint8_t *)src + i);
+      uint8x16_t r;
+      if (flip) {
+        uint8x16_t in = vandq_u8(vcgeq_u8(v, va), vcleq_u8(v, vb));
+        r = veorq_u8(v, vandq_u8(in, vdupq_n_u8(0x20)));
+      } else {
+        r = vbslq_u8(vceqq_u8(v, va), vb, v);
+      }
+      vst1q_u8((uint8_t *)dst + i, r);
+    }
+#else
+    // single bytes until the input is word aligned (no unaligned loads on Xtensa)
+    for (; i < len && ((uintptr_t)(src + i) & 3) != 0; i++) {
+      uint8_t c = (uint8_t)src[i];
+      dst[i] = (char)(flip ? (c >= a && c <= b ? c ^ 0x20 : c) : (c == a ? b : c));
+    }
+    for (; i + 4 <= len; i += 4) {
+      uint32_t w;
+      memcpy(&w, src + i, 4);
+      w = flip ? swarFlipCase(w, a, b) : swarReplace(w, a, b);
+      memcpy(dst + i, &w, 4);
+    }
+#endif
+    for (; i < len; i++) {
+      uint8_t c = (uint8_t)src[i];
+      dst[i] = (char)(flip ? (c >= a && c <= b ? c ^ 0x20 : c) : (c == a ? b : c));
+    }
+  }
+
+  // length of input that fits into output (incl. '\0')
+  static inline size_t fitLength(const char *input, size_t output_size) {
+    size_t len = strlen(input);
+    return len < output_size ? len : output_size - 1;
+  }
+
+  static inline size_t bulkTransform(const char *input, char *output, size_t output_size, uint8_t a, uint8_t b,
+                                     bool flip) {
+    ESP_STR_PROFILE(Transform, input ? strlen(input) : 0);
+    if (input == NULL || output == NULL || output_size == 0)
+      return 0;
+    size_t len = fitLength(input, output_size);
+    bulkKernel(input, output, len, a, b, flip);
+    output[len] = '\0';
+    return len;
+  }
+
+  // value of a digit in base 2..36, >= 36 if no digit
+  static inline uint8_t digitValue(char c) {
+    if (c >= '0' && c <= '9')
+      return (uint8_t)(c - '0');
+    c |= 0x20; // lowercase
+    if (c >= 'a' && c <= 'z')
+      return (uint8_t)(c - 'a' + 10);
+    return 0xFF;
+  }
+
+  static inline bool equalsIgnoreCase(const char *str, size_t len, const char *word) {
+    size_t i = 0;
+    for (; i < len && word[i] != '\0'; i++) {
+      char c = str[i];
+      if (c >= 'A' && c <= 'Z')
+        c += 32;
+      if (c != word[i])
+        return false;
+    }
+    return i == len && word[i] == '\0';
+  }
+
+  static constexpr int MAX_FAST_POW10 = 22; // 10^22 is the largest exact double
+
+  /**
+   * *******************************************************************
+   * @brief   integer-only "value / divisor" with decimals and unit,
+   *          rounded half to even (same as printf), e.g. "1.50 KiB"
+   * @param   buf       destination buffer
+   * @param   size      size of destination buffer (incl. '\0')
+   * @param   value     dividend
+   * @param   shift     > 0: divisor is 2^shift, otherwise use divisor
+   * @param   divisor   divisor (used if shift is 0), must be < 2^60
+   * @param   decimals  decimal places, 0..6
+   * @param   unit      unit appended after a space, may be NULL
+   * @param   suffix    appended after the unit, may be NULL
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   * *******************************************************************/
+  static char *formatRatio(char *buf, size_t size, uint64_t value, int shift, uint64_t divisor, int decimals,
+                           const char *unit, const char *suffix = NULL) {
+    if (decimals < 0)
+      decimals = 0;
+    if (decimals > MAX_FLOAT_DECIMALS)
+      decimals = MAX_FLOAT_DECIMALS;
+    uint64_t quotient, remainder;
+    if (shift > 0) {
+      divisor = 1ull << shift;
+      quotient = value >> shift;
+      remainder = value & (divisor - 1);
+    } else {
+      quotient = value / divisor;
+      remainder = value % divisor;
+    }
+    // long division digit by digit, remainder * 10 can not overflow
+    uint32_t fraction = 0;
+    for (int i = 0; i < decimals; i++) {
+      remainder *= 10;
+      fraction = fraction * 10 + (uint32_t)(remainder / divisor);
+      remainder %= divisor;
+    }
+    uint64_t twice = remainder * 2;
+    uint32_t last = decimals ? fraction : (uint32_t)quotient;
+    if (twice > divisor || (twice == divisor && (last & 1))) {
+      if (++fraction >= POW10[decimals]) {
+        fraction = 0;
+        quotient++;
+      }
+    }
+
+    char number[MAX_INT_DIGITS + MAX_FLOAT_DECIMALS + 2];
+    char *end = number + sizeof(number);
+    char *start = end;
+    if (decimals > 0) {
+      start = writeFixed32(start, fraction, decimals);
+      *--start = '.';
+    }
+    start = writeUnsigned64(start, quotient);
+
+    char tmp[sizeof(number) + 24];
+    size_t len = end - start;
+    memcpy(tmp, start, len);
+    size_t unitLen = unit ? strlen(unit) : 0;
+    size_t suffixLen = suffix ? strlen(suffix) : 0;
+    if (len + 1 + unitLen + suffixLen > sizeof(tmp))
+      return NULL;
+    if (unitLen || suffixLen)
+      tmp[len++] = ' ';
+    if (unitLen)
+      memcpy(tmp + len, unit, unitLen);
+    len += unitLen;
+    if (suffixLen)
+      memcpy(tmp + len, suffix, suffixLen);
+    len += suffixLen;
+    return copyOut(buf, size, tmp, tmp + len);
+  }
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   Encrypts a password and encodes it in Base64 format
+   * @param   input         Plaintext password to be encrypted
+   * @param   key           16-byte AES key used for encryption
+   * @param   output        Buffer to store the Base64-encoded, encrypted
+   * password
+   * @param   maxOutputSize Maximum size of the output buffer
+   * @return  true if encryption and Base64 encoding is successful
+   * *******************************************************************/
+  static bool encryptPassword(const char *input, const unsigned char *key,
+                              char *output, size_t maxOutputSize) {
+    if (!input || !key || !output || maxOutputSize == 0)
+      return false;
+
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_enc(&aes, key, 128);
+    bool ok = encryptWithContext(&aes, input, output, maxOutputSize);
+    mbedtls_aes_free(&aes);
+    return ok;
+  }
+
   /**
    * *******************************************************************
    * @brief   Decrypts a Base64-encoded, encrypted password
@@ -100,130 +1222,431 @@ public:
     if (!input || !key || !output || maxOutputSize == 0)
       return false;
 
-    unsigned char encrypted[128 + AES_BLOCK_SIZE] = {0};
-    unsigned char decrypted[128 + AES_BLOCK_SIZE] = {0};
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_dec(&aes, key, 128);
+    bool ok = decryptWithContext(&aes, input, output, maxOutputSize);
+    mbedtls_aes_free(&aes);
+    return ok;
+  }
 
-    size_t encryptedLength = sizeof(encrypted);
-    if (mbedtls_base64_decode(encrypted, encryptedLength, &encryptedLength,
-                              (const unsigned char *)input,
-                              strlen(input)) != 0) {
-      return false; // error Base64-decoding
-    }
+  /**
+   * *******************************************************************
+   * @brief   Encrypts a secret with AES-128-GCM and a random nonce,
+   *          output is "$2$" followed by nonce, ciphertext and tag in
+   *          Base64 format
+   * @param   input         Plaintext secret to be encrypted (max. 128 chars)
+   * @param   key           16-byte AES key used for encryption
+   * @param   output        Buffer to store the Base64-encoded envelope
+   *                        (needs secretEncodedSize(len) bytes)
+   * @param   maxOutputSize Maximum size of the output buffer
+   * @return  true if encryption and Base64 encoding is successful
+   * *******************************************************************/
+  static bool encryptSecret(const char *input, const unsigned char *key,
+                            char *output, size_t maxOutputSize) {
+    if (!input || !key || !output || maxOutputSize == 0)
+      return false;
+
+    mbedtls_gcm_context gcm;
+    mbedtls_gcm_init(&gcm);
+    bool ok = mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, 128) == 0 &&
+              encryptSecretWithContext(&gcm, input, output, maxOutputSize);
+    mbedtls_gcm_free(&gcm);
+    return ok;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   Decrypts and verifies a secret from encryptSecret(), also
+   *          accepts the legacy format of encryptPassword()
+   *          Input with the "$2$" prefix is always verified as envelope,
+   *          any other input is decrypted as legacy password.
+   * @param   input         Base64-encoded envelope or legacy password
+   * @param   key           16-byte AES key used for decryption
+   * @param   output        Buffer to store the decrypted secret
+   * @param   maxOutputSize Maximum size of the output buffer
+   * @param   legacy        optional: set to true if the input was in the
+   *                        legacy format and should be encrypted again
+   * @return  true if decryption and verification were successful
+   * *******************************************************************/
+  static bool decryptSecret(const char *input, const unsigned char *key,
+                            char *output, size_t maxOutputSize,
+                            bool *legacy = NULL) {
+    if (!input || !key || !output || maxOutputSize == 0)
+      return false;
 
+    mbedtls_gcm_context gcm;
     mbedtls_aes_context aes;
+    mbedtls_gcm_init(&gcm);
     mbedtls_aes_init(&aes);
-    mbedtls_aes_setkey_dec(&aes, key, 128);
+    bool ok = mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, 128) == 0 &&
+              decryptSecretWithContext(&gcm, &aes, key, input, output,
+                                       maxOutputSize, legacy);
+    mbedtls_aes_free(&aes);
+    mbedtls_gcm_free(&gcm);
+    return ok;
+  }
 
-    for (size_t i = 0; i < encryptedLength; i += AES_BLOCK_SIZE) {
-      mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_DECRYPT, encrypted + i,
-                            decrypted + i);
+  /**
+   * *******************************************************************
+   * @brief   buffer size needed for base64Encode()
+   * @param   len      number of input bytes
+   * @param   padding  false for URL-safe output without '='
+   * @return  number of chars incl. the terminating '\0'
+   * *******************************************************************/
+  static constexpr size_t base64EncodedSize(size_t len, bool padding = true) {
+    return (padding ? (len + 2) / 3 * 4 : len / 3 * 4 + (len % 3 ? len % 3 + 1 : 0)) + 1;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   max. buffer size needed for base64Decode()
+   * @param   len   number of Base64 chars
+   * @return  max. number of decoded bytes
+   * *******************************************************************/
+  static constexpr size_t base64DecodedSize(size_t len) {
+    return len / 4 * 3 + (len % 4 ? len % 4 - 1 : 0);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   buffer size needed for the output of encryptSecret()
+   * @param   len   length of the secret
+   * @return  number of chars incl. the terminating '\0'
+   * *******************************************************************/
+  static constexpr size_t secretEncodedSize(size_t len) {
+    return SECRET_PREFIX_LENGTH + base64EncodedSize(SECRET_OVERHEAD + len);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   encode binary data in Base64 format
+   * @param   buf      destination buffer, see base64EncodedSize()
+   * @param   size     size of destination buffer (incl. '\0')
+   * @param   data     input data
+   * @param   len      length of input data
+   * @param   urlSafe  use URL-safe alphabet ('-', '_') without padding
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   * *******************************************************************/
+  static char *base64Encode(char *buf, size_t size, const void *data,
+                            size_t len, bool urlSafe = false) {
+    ESP_STR_PROFILE(Base64Encode, len);
+    if (buf == NULL || (data == NULL && len > 0))
+      return NULL;
+    if (size < base64EncodedSize(len, !urlSafe))
+      return NULL; // error buffer to small
+
+    const char *alphabet = urlSafe ? BASE64URL_CHARS : BASE64_CHARS;
+    const unsigned char *src = (const unsigned char *)data;
+    char *dst = buf;
+    // 3 bytes -> 4 chars per step
+    for (; len >= 3; len -= 3, src += 3, dst += 4) {
+      uint32_t v = ((uint32_t)src[0] << 16) | ((uint32_t)src[1] << 8) | src[2];
+      dst[0] = alphabet[v >> 18];
+      dst[1] = alphabet[(v >> 12) & 0x3F];
+      dst[2] = alphabet[(v >> 6) & 0x3F];
+      dst[3] = alphabet[v & 0x3F];
     }
-    mbedtls_aes_free(&aes);
+    if (len > 0) {
+      uint32_t v = ((uint32_t)src[0] << 16) | (len > 1 ? (uint32_t)src[1] << 8 : 0);
+      *dst++ = alphabet[v >> 18];
+      *dst++ = alphabet[(v >> 12) & 0x3F];
+      if (len > 1) {
+        *dst++ = alphabet[(v >> 6) & 0x3F];
+      } else if (!urlSafe) {
+        *dst++ = '=';
+      }
+      if (!urlSafe) {
+        *dst++ = '=';
+      }
+    }
+    *dst = '\0';
+    return dst;
+  }
 
-    size_t actualLength = removePadding(decrypted, encryptedLength);
-    if (actualLength == 0 || actualLength >= maxOutputSize) {
-      return false; // error
+  /**
+   * *******************************************************************
+   * @brief   decode Base64 data (standard or URL-safe, padding optional)
+   *          buf may be the same as src to decode in place
+   * @param   buf      destination buffer, see base64DecodedSize()
+   * @param   size     size of destination buffer
+   * @param   src      Base64 input
+   * @param   len      number of Base64 chars
+   * @param   outLen   optional: number of decoded bytes
+   * @return  true if successful, false on invalid input or buffer to small
+   * *******************************************************************/
+  static bool base64Decode(void *buf, size_t size, const char *src, size_t len,
+                           size_t *outLen = NULL) {
+    ESP_STR_PROFILE(Base64Decode, len);
+    if (buf == NULL || (src == NULL && len > 0))
+      return false;
+    if (len > 0 && len % 4 == 0 && src[len - 1] == '=') {
+      len -= (src[len - 2] == '=') ? 2 : 1;
     }
+    if (len % 4 == 1)
+      return false; // error: invalid length
+    size_t decodedLength = base64DecodedSize(len);
+    if (decodedLength > size)
+      return false; // error buffer to small
 
-    memcpy(output, decrypted, actualLength);
-    output[actualLength] = '\0';
+    const unsigned char *s = (const unsigned char *)src;
+    unsigned char *dst = (unsigned char *)buf;
+    // 4 chars -> 3 bytes per step, all chars are read before writing
+    for (; len >= 4; len -= 4, s += 4, dst += 3) {
+      uint32_t a = BASE64_DECODE[s[0]], b = BASE64_DECODE[s[1]];
+      uint32_t c = BASE64_DECODE[s[2]], d = BASE64_DECODE[s[3]];
+      if ((a | b | c | d) & 0x80)
+        return false; // error: invalid char
+      uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+      dst[0] = (unsigned char)(v >> 16);
+      dst[1] = (unsigned char)(v >> 8);
+      dst[2] = (unsigned char)v;
+    }
+    if (len > 0) {
+      uint32_t a = BASE64_DECODE[s[0]], b = BASE64_DECODE[s[1]];
+      uint32_t c = len > 2 ? BASE64_DECODE[s[2]] : 0;
+      if ((a | b | c) & 0x80)
+        return false; // error: invalid char
+      uint32_t v = (a << 18) | (b << 12) | (c << 6);
+      dst[0] = (unsigned char)(v >> 16);
+      if (len > 2) {
+        dst[1] = (unsigned char)(v >> 8);
+      }
+    }
+    if (outLen)
+      *outLen = decodedLength;
     return true;
   }
 
   /**
    * *******************************************************************
-   * @brief   create String from integer
-   * @param   value as int8_t
-   * @return  pointer to char array - pay attention, it is local static
+   * @brief   encode binary data as hex string, e.g. MAC "AA:BB:CC:..."
+   *          buf and data may be the same buffer (encoded in place from
+   *          the end, buf must be large enough for the result)
+   * @param   buf        destination buffer
+   * @param   size       size of destination buffer, needs 2 * len + 1
+   *                     (3 * len with separator)
+   * @param   data       binary data
+   * @param   len        length of binary data
+   * @param   upper      true: "AB", false: "ab"
+   * @param   separator  char between the bytes, '\0' = none
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
    * *******************************************************************/
-  static inline const char *intToString(int8_t value) {
-    static char ret_str[5];
-    snprintf(ret_str, sizeof(ret_str), "%" PRId8, value);
-    return ret_str;
+  static char *hexEncode(char *buf, size_t size, const void *data, size_t len, bool upper = false,
+                         char separator = '\0') {
+    if (buf == NULL || (data == NULL && len > 0))
+      return NULL;
+    size_t outLen = len * 2 + (separator && len > 0 ? len - 1 : 0);
+    if (outLen >= size)
+      return NULL; // error buffer to small
+    const char *digits = upper ? HEX_UPPER : HEX_LOWER;
+    const unsigned char *src = (const unsigned char *)data;
+    char *end = buf + outLen;
+    *end = '\0';
+    // backwards, so the input is read before it is overwritten (in place)
+    char *p = end;
+    for (size_t i = len; i-- > 0;) {
+      unsigned char b = src[i];
+      *--p = digits[b & 0x0F];
+      *--p = digits[b >> 4];
+      if (separator && i > 0)
+        *--p = separator;
+    }
+    return end;
   }
 
   /**
    * *******************************************************************
-   * @brief   create String from integer
-   * @param   value as uint8_t
-   * @return  pointer to char array - pay attention, it is local static
+   * @brief   decode hex string to binary data, upper and lower case,
+   *          ':', '-' or ' ' between the bytes are skipped
+   *          buf and src may be the same buffer (decoded in place)
+   * @param   buf     destination buffer
+   * @param   size    size of destination buffer
+   * @param   src     hex string
+   * @param   len     length of hex string
+   * @param   outLen  optional: length of the decoded data
+   * @return  true if successful, false on invalid input or buffer to small
    * *******************************************************************/
-  static inline const char *intToString(uint8_t value) {
-    static char ret_str[5];
-    snprintf(ret_str, sizeof(ret_str), "%" PRIu8, value);
-    return ret_str;
+  static bool hexDecode(void *buf, size_t size, const char *src, size_t len, size_t *outLen = NULL) {
+    if (buf == NULL || (src == NULL && len > 0))
+      return false;
+    unsigned char *dst = (unsigned char *)buf;
+    size_t n = 0;
+    for (size_t i = 0; i < len;) {
+      if (n > 0 && isHexSeparator(src[i]) && i + 1 < len)
+        i++; // one separator between two bytes
+      if (i + 1 >= len)
+        return false; // odd number of digits
+      uint8_t high = HEX_DECODE[(unsigned char)src[i]];
+      uint8_t low = HEX_DECODE[(unsigned char)src[i + 1]];
+      if ((high | low) & 0x80)
+        return false; // invalid char
+      if (n >= size)
+        return false; // error buffer to small
+      dst[n++] = (unsigned char)(high << 4 | low);
+      i += 2;
+    }
+    if (outLen)
+      *outLen = n;
+    return true;
   }
 
   /**
    * *******************************************************************
-   * @brief   create String from integer
-   * @param   value as uint16_t
-   * @return  pointer to char array - pay attention, it is local static
+   * @brief   binary data from a hex string literal at compile time
+   *          invalid hex digits are only a compile error if the result is
+   *          constexpr, otherwise they call abort() at runtime:
+   *          static constexpr auto KEY = EspStrUtil::hexLiteral("000102...0f");
+   *          EspStrUtil::encryptSecret(input, KEY.data, output, size);
+   * @param   str  hex string literal with an even number of digits
+   * @return  bytes
    * *******************************************************************/
-  static inline const char *intToString(uint16_t value) {
-    static char ret_str[10];
-    snprintf(ret_str, sizeof(ret_str), "%" PRId16, value);
-    return ret_str;
+  template <size_t N>
+  static constexpr EspBytes<(N - 1) / 2> hexLiteral(const char (&str)[N]) {
+    static_assert(N % 2 == 1, "hexLiteral needs an even number of hex digits");
+    EspBytes<(N - 1) / 2> bytes = {};
+    for (size_t i = 0; i < (N - 1) / 2; i++) {
+      bytes.data[i] = (uint8_t)(hexLiteralNibble(str[2 * i]) << 4 | hexLiteralNibble(str[2 * i + 1]));
+    }
+    return bytes;
   }
 
   /**
    * *******************************************************************
-   * @brief   create String from integer
-   * @param   value as int
-   * @return  pointer to char array - pay attention, it is local static
+   * @brief   compare memory in constant time (for secrets, tags, hashes)
+   *          the time does not depend on the position of the first
+   *          difference
+   * @param   a    first buffer
+   * @param   b    second buffer
+   * @param   len  number of bytes
+   * @return  true if equal
+   * *******************************************************************/
+  static bool secureEquals(const void *a, const void *b, size_t len) {
+    const volatile unsigned char *pa = (const volatile unsigned char *)a;
+    const volatile unsigned char *pb = (const volatile unsigned char *)b;
+    unsigned char diff = 0;
+    for (size_t i = 0; i < len; i++) {
+      diff |= pa[i] ^ pb[i];
+    }
+    return diff == 0;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   compare a string with a secret in constant time, e.g. a
+   *          token of a web request. The time only depends on the
+   *          length of the secret, not on its content.
+   * @param   input   string to check
+   * @param   secret  expected string
+   * @return  true if equal
+   * *******************************************************************/
+  static bool secureEquals(const char *input, const char *secret) {
+    if (input == NULL || secret == NULL)
+      return false;
+    size_t secretLen = strlen(secret);
+    size_t inputLen = strnlen(input, secretLen + 1);
+    unsigned char diff = inputLen != secretLen;
+    const volatile char *in = input;
+    for (size_t i = 0; i < secretLen; i++) {
+      size_t j = i < inputLen ? i : 0; // never read past the input
+      diff |= (unsigned char)(in[j] ^ secret[i]);
+    }
+    return diff == 0;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   overwrite memory with zeros, not removed by the optimizer
+   *          like a memset() before a buffer goes out of scope
+   * @param   buf  buffer with secret data
+   * @param   len  length of buffer
+   * @return  none
+   * *******************************************************************/
+  static void secureZero(void *buf, size_t len) {
+    if (buf != NULL)
+      mbedtls_platform_zeroize(buf, len);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   convert integer to decimal string in caller buffer
+   * @param   buf   destination buffer
+   * @param   size  size of destination buffer (incl. '\0')
+   * @param   value any 8/16/32/64-bit signed or unsigned integer
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
    * *******************************************************************/
-  static inline const char *intToString(int value) {
-    static char ret_str[10];
-    snprintf(ret_str, sizeof(ret_str), "%" PRIi16, value);
-    return ret_str;
+  template <typename T>
+  static inline char *toChars(char *buf, size_t size, T value) {
+    static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "toChars requires an integer type");
+    ESP_STR_PROFILE(ToChars, sizeof(T));
+    typedef typename std::make_unsigned<T>::type U;
+    if (buf == NULL || size == 0)
+      return NULL;
+
+    char tmp[MAX_INT_DIGITS + 1];
+    char *end = tmp + sizeof(tmp);
+    char *start;
+    U absValue = (U)value;
+    bool negative = false;
+    if (std::is_signed<T>::value && value < 0) {
+      negative = true;
+      absValue = (U)(U(0) - absValue); // also valid for the minimum value
+    }
+    if (sizeof(U) > sizeof(uint32_t)) {
+      start = writeUnsigned64(end, (uint64_t)absValue);
+    } else {
+      start = writeUnsigned32(end, (uint32_t)absValue);
+    }
+    if (negative) {
+      *--start = '-';
+    }
+
+    return copyOut(buf, size, start, end);
   }
 
   /**
    * *******************************************************************
    * @brief   create String from integer
-   * @param   value as int32_t
+   * @param   value any 8/16/32/64-bit signed or unsigned integer
    * @return  pointer to char array - pay attention, it is local static
    * *******************************************************************/
-  static inline const char *intToString(int32_t value) {
-    static char ret_str[64];
-    snprintf(ret_str, sizeof(ret_str), "%" PRId32, value);
+  template <typename T>
+  static inline const char *intToString(T value) {
+    constexpr size_t size = std::numeric_limits<T>::digits10 + 3;
+    ESP_STR_RESULT(ret_str, size);
+    toChars(ret_str, size, value);
     return ret_str;
   }
 
   /**
    * *******************************************************************
-   * @brief   create String from integer
-   * @param   value as int64_t
-   * @return  pointer to char array - pay attention, it is local static
+   * @brief   convert float or double to fixed-point string in caller buffer
+   * @param   buf       destination buffer
+   * @param   size      size of destination buffer (incl. '\0')
+   * @param   value     float or double value
+   * @param   decimals  decimal precision (fast path for 0..6)
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
    * *******************************************************************/
-  static inline const char *intToString(uint64_t value) {
-    static char ret_str[21];
-    char *ptr = ret_str;
-    do {
-      *ptr++ = (value % 10) + '0';
-      value /= 10;
-    } while (value != 0);
-    *ptr-- = '\0';
-    char *start_ptr = ret_str;
-    char tmp_char;
-    while (start_ptr < ptr) {
-      tmp_char = *start_ptr;
-      *start_ptr++ = *ptr;
-      *ptr-- = tmp_char;
-    }
-    return ret_str;
+  template <typename T>
+  static inline char *floatToChars(char *buf, size_t size, T value, int decimals = 1) {
+    static_assert(std::is_floating_point<T>::value, "floatToChars requires a float type");
+    return formatFixed(buf, size, value, decimals);
   }
 
   /**
    * *******************************************************************
-   * @brief   create String from integer
-   * @param   value as intmax_t
-   * @return  pointer to char array - pay attention, it is local static
+   * @brief   convert float or double to fixed-point string in caller buffer
+   *          with compile-time precision, e.g. floatToChars<2>(buf, n, v)
+   * @param   buf       destination buffer
+   * @param   size      size of destination buffer (incl. '\0')
+   * @param   value     float or double value
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
    * *******************************************************************/
-  static inline const char *intToString(intmax_t value) {
-    static char ret_str[64];
-    snprintf(ret_str, sizeof(ret_str), "%" PRIdMAX, value);
-    return ret_str;
+  template <int DECIMALS, typename T>
+  static inline char *floatToChars(char *buf, size_t size, T value) {
+    static_assert(std::is_floating_point<T>::value, "floatToChars requires a float type");
+    static_assert(DECIMALS >= 0 && DECIMALS <= MAX_FLOAT_DECIMALS, "DECIMALS must be 0..6");
+    return formatFixed(buf, size, value, DECIMALS);
   }
 
   /**
@@ -232,14 +1655,14 @@ public:
    * precision
    * @param   float or double value
    * @param   decimal precision
-   * @return  string representation of the float or double value
+   * @return  pointer to char array - pay attention, it is local static
    * *******************************************************************/
   template <typename T>
   static inline const char *floatToString(T value, int decimals = 1) {
-    static char ret_str[64];
-    char format[8];
-    snprintf(format, sizeof(format), "%%.%df", decimals);
-    snprintf(ret_str, sizeof(ret_str), format, value);
+    ESP_STR_RESULT(ret_str, 64);
+    if (floatToChars(ret_str, 64, value, decimals) == NULL) {
+      ret_str[0] = '\0';
+    }
     return ret_str;
   }
 
@@ -253,6 +1676,7 @@ public:
    * *******************************************************************/
   static inline char *strcat_safe(char *dest, const char *src,
                                   size_t dest_size) {
+    ESP_STR_PROFILE(StrCat, src ? strlen(src) : 0);
     size_t dest_len = strlen(dest);
     size_t src_len = strlen(src);
 
@@ -260,7 +1684,7 @@ public:
       // not enough space
       return NULL;
     }
-    strcat(dest, src);
+    memcpy(dest + dest_len, src, src_len + 1); // no further scan like strcat
     return dest;
   }
 
@@ -268,13 +1692,49 @@ public:
    * *******************************************************************
    * @brief   convert String to BOOL if String contains true/false
    * @param   str e
-   * @return  true/false
+   * @return  true for "true", "1", "on" or "yes", otherwise false
    * *******************************************************************/
   static inline bool stringToBool(const char *str) {
-    if (strcmp(str, "true") == 0) {
-      return true;
-    }
-    return false;
+    return str != NULL && stringToBool(str, strlen(str));
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   convert String with length to BOOL (see stringToBool)
+   * @param   str string, does not need to be null terminated
+   * @param   len length of string
+   * @return  true for "true", "1", "on" or "yes", otherwise false
+   * *******************************************************************/
+  static inline bool stringToBool(const char *str, size_t len) {
+    bool value = false;
+    return str != NULL && parseBool(str, str + len, value) && value;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   invalidate the cached local time of the date/time functions
+   *          call this after the timezone (TZ) was changed
+   * @param   none
+   * @return  none
+   * *******************************************************************/
+  static inline void invalidateClockCache() { clockGeneration() = clockGeneration() + 1; }
+
+  /**
+   * *******************************************************************
+   * @brief   create date and time as String in caller buffer
+   *          "DD.MM.YYYY - HH:MM:SS"
+   * @param   buf   destination buffer
+   * @param   size  size of destination buffer (incl. '\0')
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   * *******************************************************************/
+  static inline char *getDateTimeString(char *buf, size_t size) {
+    ESP_STR_PROFILE(DateTime, 0);
+    const ClockCache &c = clockCache(time(NULL));
+    char tmp[21];
+    memcpy(tmp, c.date, 10);
+    memcpy(tmp + 10, " - ", 3);
+    memcpy(tmp + 13, c.time, 8);
+    return copyOut(buf, size, tmp, tmp + sizeof(tmp));
   }
 
   /**
@@ -284,27 +1744,24 @@ public:
    * @return  pointer to date and time String (local static memory)
    * *******************************************************************/
   static inline const char *getDateTimeString() {
-    /* ---------------- INFO ---------------------------------
-    dti.tm_year + 1900  // years since 1900
-    dti.tm_mon + 1      // January = 0 (!)
-    dti.tm_mday         // day of month
-    dti.tm_hour         // hours since midnight  0-23
-    dti.tm_min          // minutes after the hour  0-59
-    dti.tm_sec          // seconds after the minute  0-61*
-    dti.tm_wday         // days since Sunday 0-6
-    dti.tm_isdst        // Daylight Saving Time flag
-    --------------------------------------------------------- */
-    static char dateTimeInfo[74] = {'\0'}; // Date and time info String
-    time_t now;                            // this is the epoch
-    tm dti; // the structure tm holds time information in a more convient way
-    time(&now);              // read the current time
-    localtime_r(&now, &dti); // update the structure tm with the current time
-    snprintf(dateTimeInfo, sizeof(dateTimeInfo),
-             "%02d.%02d.%02d - %02i:%02i:%02i", dti.tm_mday, (dti.tm_mon + 1),
-             (dti.tm_year + 1900), dti.tm_hour, dti.tm_min, dti.tm_sec);
+    ESP_STR_RESULT(dateTimeInfo, 22); // Date and time info String
+    getDateTimeString(dateTimeInfo, 22);
     return dateTimeInfo;
   }
 
+  /**
+   * *******************************************************************
+   * @brief   create date String in caller buffer "DD.MM.YYYY"
+   * @param   buf   destination buffer
+   * @param   size  size of destination buffer (incl. '\0')
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   * *******************************************************************/
+  static inline char *getDateString(char *buf, size_t size) {
+    ESP_STR_PROFILE(DateTime, 0);
+    const ClockCache &c = clockCache(time(NULL));
+    return copyOut(buf, size, c.date, c.date + 10);
+  }
+
   /**
    * *******************************************************************
    * @brief   create date  String
@@ -312,15 +1769,24 @@ public:
    * @return  pointer to date String (local static memory)
    * *******************************************************************/
   static inline const char *getDateString() {
-    static char dateInfo[74] = {'\0'}; // Date String
-    time_t now;                        // this is the epoch
-    tm dti; // the structure tm holds time information in a more convient way
-    time(&now);              // read the current time
-    localtime_r(&now, &dti); // update the structure tm with the current time
-    snprintf(dateInfo, sizeof(dateInfo), "%02d.%02d.%02d", dti.tm_mday,
-             (dti.tm_mon + 1), (dti.tm_year + 1900));
+    ESP_STR_RESULT(dateInfo, 11); // Date String
+    getDateString(dateInfo, 11);
     return dateInfo;
   }
+
+  /**
+   * *******************************************************************
+   * @brief   create date String in caller buffer "YYYY-MM-DD"
+   * @param   buf   destination buffer
+   * @param   size  size of destination buffer (incl. '\0')
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   * *******************************************************************/
+  static inline char *getDateStringWeb(char *buf, size_t size) {
+    ESP_STR_PROFILE(DateTime, 0);
+    const ClockCache &c = clockCache(time(NULL));
+    return copyOut(buf, size, c.dateWeb, c.dateWeb + 10);
+  }
+
   /**
    * *******************************************************************
    * @brief   create date  String
@@ -328,16 +1794,24 @@ public:
    * @return  pointer to date String (local static memory)
    * *******************************************************************/
   static inline const char *getDateStringWeb() {
-    static char dateInfo[74] = {'\0'}; // Date String
-    time_t now;                        // this is the epoch
-    tm dti; // the structure tm holds time information in a more convient way
-    time(&now);              // read the current time
-    localtime_r(&now, &dti); // update the structure tm with the current time
-    snprintf(dateInfo, sizeof(dateInfo), "%02d-%02d-%02d", (dti.tm_year + 1900),
-             (dti.tm_mon + 1), dti.tm_mday);
+    ESP_STR_RESULT(dateInfo, 11); // Date String
+    getDateStringWeb(dateInfo, 11);
     return dateInfo;
   }
 
+  /**
+   * *******************************************************************
+   * @brief   create time String in caller buffer "HH:MM:SS"
+   * @param   buf   destination buffer
+   * @param   size  size of destination buffer (incl. '\0')
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   * *******************************************************************/
+  static inline char *getTimeString(char *buf, size_t size) {
+    ESP_STR_PROFILE(DateTime, 0);
+    const ClockCache &c = clockCache(time(NULL));
+    return copyOut(buf, size, c.time, c.time + 8);
+  }
+
   /**
    * *******************************************************************
    * @brief   create time as String
@@ -345,54 +1819,161 @@ public:
    * @return  pointer to time String (local static memory)
    * *******************************************************************/
   static inline const char *getTimeString() {
-    static char timeInfo[74] = {'\0'}; // Date and time info String
-    time_t now;                        // this is the epoch
-    tm dti; // the structure tm holds time information in a more convient way
-    time(&now);              // read the current time
-    localtime_r(&now, &dti); // update the structure tm with the current time
-    snprintf(timeInfo, sizeof(timeInfo), "%02i:%02i:%02i", dti.tm_hour,
-             dti.tm_min, dti.tm_sec);
+    ESP_STR_RESULT(timeInfo, 9); // Date and time info String
+    getTimeString(timeInfo, 9);
     return timeInfo;
   }
 
   /**
    * *******************************************************************
-   * @brief   format build date/time information
-   * @param   date input string
-   * @return  hash value
+   * @brief   create log timestamp in caller buffer "HH:MM:SS.mmm"
+   * @param   buf   destination buffer
+   * @param   size  size of destination buffer (incl. '\0')
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
    * *******************************************************************/
-  static inline const char *getBuildDateTime() {
-    static char formatted_date[32] = {0};
-    // Monatsnamen für die Umwandlung in Zahlen
-    const char *months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
-                            "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
-    char month_text[4] = {0};
-    int day, year;
-    // Extrahiere den Monat, Tag und Jahr aus dem __DATE__ String
-    sscanf(__DATE__, "%s %d %d", month_text, &day, &year);
-
-    // Finde den Monat im Array und konvertiere ihn in eine Zahl
-    int month = 0;
+  static inline char *getTimeStringMs(char *buf, size_t size) {
+    ESP_STR_PROFILE(DateTime, 0);
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    const ClockCache &c = clockCache(tv.tv_sec);
+    char tmp[12];
+    memcpy(tmp, c.time, 8);
+    tmp[8] = '.';
+    writeFixed32(tmp + 12, (uint32_t)(tv.tv_usec / 1000), 3);
+    return copyOut(buf, size, tmp, tmp + sizeof(tmp));
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   create ISO-8601 timestamp with UTC offset in caller buffer
+   *          "YYYY-MM-DDTHH:MM:SS+hh:mm" or "YYYY-MM-DDTHH:MM:SS.mmm+hh:mm"
+   * @param   buf     destination buffer
+   * @param   size    size of destination buffer (incl. '\0')
+   * @param   millis  add milliseconds
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   * *******************************************************************/
+  static inline char *getIsoTimeString(char *buf, size_t size,
+                                       bool millis = false) {
+    ESP_STR_PROFILE(DateTime, 0);
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    const ClockCache &c = clockCache(tv.tv_sec);
+    char tmp[29];
+    char *p = tmp;
+    memcpy(p, c.dateWeb, 10);
+    p[10] = 'T';
+    memcpy(p + 11, c.time, 8);
+    p += 19;
+    if (millis) {
+      *p++ = '.';
+      p = writeFixed32(p + 3, (uint32_t)(tv.tv_usec / 1000), 3) + 3;
+    }
+    int32_t offset = c.utcOffset / 60;
+    *p++ = offset < 0 ? '-' : '+';
+    if (offset < 0)
+      offset = -offset;
+    put2(p, offset / 60);
+    p[2] = ':';
+    put2(p + 3, offset % 60);
+    p += 5;
+    return copyOut(buf, size, tmp, p);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   parse __DATE__ ("Mmm dd yyyy") and __TIME__ ("hh:mm:ss")
+   *          at compile time
+   * @param   date  __DATE__
+   * @param   time  __TIME__
+   * @return  build info
+   * *******************************************************************/
+  static constexpr EspBuildInfo parseBuildInfo(const char *date,
+                                               const char *time) {
+    EspBuildInfo info = {};
+    // month from the three letters
+    const char *months = "JanFebMarAprMayJunJulAugSepOctNovDec";
     for (int i = 0; i < 12; i++) {
-      if (strcmp(month_text, months[i]) == 0) {
-        month = i + 1;
-        break;
+      if (date[0] == months[i * 3] && date[1] == months[i * 3 + 1] &&
+          date[2] == months[i * 3 + 2]) {
+        info.month = (uint8_t)(i + 1);
       }
     }
+    info.day = (uint8_t)((date[4] == ' ' ? 0 : (date[4] - '0') * 10) + (date[5] - '0'));
+    info.year = (uint16_t)((date[7] - '0') * 1000 + (date[8] - '0') * 100 +
+                           (date[9] - '0') * 10 + (date[10] - '0'));
+    info.hour = (uint8_t)((time[0] - '0') * 10 + (time[1] - '0'));
+    info.minute = (uint8_t)((time[3] - '0') * 10 + (time[4] - '0'));
+    info.second = (uint8_t)((time[6] - '0') * 10 + (time[7] - '0'));
+    info.epoch = (uint32_t)daysFromCivil(info.year, info.month, info.day) * 86400u +
+                 info.hour * 3600u + info.minute * 60u + info.second;
+
+    // "DD.MM.YYYY - HH:MM:SS"
+    char *p = info.dateTime;
+    p[0] = (char)('0' + info.day / 10);
+    p[1] = (char)('0' + info.day % 10);
+    p[2] = '.';
+    p[3] = (char)('0' + info.month / 10);
+    p[4] = (char)('0' + info.month % 10);
+    p[5] = '.';
+    for (int i = 0; i < 4; i++)
+      p[6 + i] = date[7 + i];
+    p[10] = ' ';
+    p[11] = '-';
+    p[12] = ' ';
+    for (int i = 0; i < 8; i++)
+      p[13 + i] = time[i];
+    p[21] = '\0';
+    return info;
+  }
 
-    // Format das Datum als "DD-MM-YYYY"
-    sprintf(formatted_date, "%02d.%02d.%d - %s", day, month, year, __TIME__);
+  /**
+   * *******************************************************************
+   * @brief   build date/time, parsed at compile time (constant in flash)
+   * @param   none
+   * @return  build info
+   * *******************************************************************/
+  static inline const EspBuildInfo &getBuildInfo() {
+    static constexpr EspBuildInfo info = parseBuildInfo(__DATE__, __TIME__);
+    return info;
+  }
 
-    return formatted_date;
+  /**
+   * *******************************************************************
+   * @brief   format build date/time information
+   * @param   none
+   * @return  build date/time "DD.MM.YYYY - HH:MM:SS" (constant)
+   * *******************************************************************/
+  static inline const char *getBuildDateTime() {
+    return getBuildInfo().dateTime;
   }
 
+  /**
+   * *******************************************************************
+   * @brief   build time as number
+   * @param   none
+   * @return  seconds since 1970-01-01 (build time taken as UTC)
+   * *******************************************************************/
+  static inline uint32_t getBuildEpoch() { return getBuildInfo().epoch; }
+
+  /**
+   * *******************************************************************
+   * @brief   version of this library
+   * @param   none
+   * @return  version
+   * *******************************************************************/
+  static constexpr EspVersion libVersion() { return EspVersion{1, 2, 0}; }
+
   /**
    * *******************************************************************
    * @brief   simple hash function
+   *          kept for compatibility (used by strDiff). Weak and the value
+   *          depends on the signedness of char of the platform, use
+   *          hash32() / xxHash32() / fnv1a32() for new code.
    * @param   str input string
    * @return  hash value
    * *******************************************************************/
   static inline unsigned int strHash(const char *str) {
+    ESP_STR_PROFILE(Hash, strlen(str));
     unsigned int hash = 0;
     while (*str) {
       hash = 31 * hash + (*str++);
@@ -400,6 +1981,104 @@ public:
     return hash;
   }
 
+  /**
+   * *******************************************************************
+   * @brief   xxHash32 of a string, also usable at compile time:
+   *          switch (EspStrUtil::hash32(topic)) {
+   *          case EspStrUtil::hash32("cmd/on"): ...
+   *          stable: standard xxHash32 with seed 0, identical on all
+   *          platforms and library versions
+   * @param   str input string
+   * @return  32-bit hash value
+   * *******************************************************************/
+  static constexpr uint32_t hash32(const char *str) {
+    return xxHash32(str, constLength(str), 0);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   xxHash32 (processes 4 bytes per step, 16-byte stripes)
+   *          stable: identical on all platforms and library versions
+   * @param   data  input data
+   * @param   len   length of input data
+   * @param   seed  optional seed
+   * @return  32-bit hash value
+   * *******************************************************************/
+  static constexpr uint32_t xxHash32(const char *data, size_t len,
+                                     uint32_t seed = 0) {
+    size_t i = 0;
+    uint32_t h = 0;
+    if (len >= 16) {
+      uint32_t v1 = seed + XXH_PRIME1 + XXH_PRIME2;
+      uint32_t v2 = seed + XXH_PRIME2;
+      uint32_t v3 = seed;
+      uint32_t v4 = seed - XXH_PRIME1;
+      for (; i + 16 <= len; i += 16) {
+        v1 = xxhRound(v1, readLE32(data + i));
+        v2 = xxhRound(v2, readLE32(data + i + 4));
+        v3 = xxhRound(v3, readLE32(data + i + 8));
+        v4 = xxhRound(v4, readLE32(data + i + 12));
+      }
+      h = rotl32(v1, 1) + rotl32(v2, 7) + rotl32(v3, 12) + rotl32(v4, 18);
+    } else {
+      h = seed + XXH_PRIME5;
+    }
+    h += (uint32_t)len;
+    return xxhFinalize(h, data + i, len - i);
+  }
+
+  static inline uint32_t xxHash32(const void *data, size_t len,
+                                  uint32_t seed = 0) {
+    ESP_STR_PROFILE(Hash, len);
+    return xxHash32((const char *)data, len, seed);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   FNV-1a 32-bit hash, also usable at compile time
+   *          stable: identical on all platforms and library versions
+   * @param   data  input data
+   * @param   len   length of input data
+   * @param   seed  start value, pass a previous result to hash
+   *                incrementally
+   * @return  32-bit hash value
+   * *******************************************************************/
+  static constexpr uint32_t fnv1a32(const char *data, size_t len,
+                                    uint32_t seed = FNV32_OFFSET) {
+    uint32_t h = seed;
+    for (size_t i = 0; i < len; i++) {
+      h = (h ^ (uint8_t)data[i]) * FNV32_PRIME;
+    }
+    return h;
+  }
+
+  static constexpr uint32_t fnv1a32(const char *str) {
+    return fnv1a32(str, constLength(str));
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   FNV-1a 64-bit hash, also usable at compile time
+   *          stable: identical on all platforms and library versions
+   * @param   data  input data
+   * @param   len   length of input data
+   * @param   seed  start value, pass a previous result to hash
+   *                incrementally
+   * @return  64-bit hash value
+   * *******************************************************************/
+  static constexpr uint64_t fnv1a64(const char *data, size_t len,
+                                    uint64_t seed = FNV64_OFFSET) {
+    uint64_t h = seed;
+    for (size_t i = 0; i < len; i++) {
+      h = (h ^ (uint8_t)data[i]) * FNV64_PRIME;
+    }
+    return h;
+  }
+
+  static constexpr uint64_t fnv1a64(const char *str) {
+    return fnv1a64(str, constLength(str));
+  }
+
   /**
    * *******************************************************************
    * @brief   helper function to check if a string has changed
@@ -419,75 +2098,400 @@ public:
   /**
    * *******************************************************************
    * @brief   helper function to replace underscore with whitespace
+   *          input and output may be the same buffer
    * @param   input string
    * @param   output string
    * @param   output_size
-   * @return  none
+   * @return  length written (without '\0')
    * *******************************************************************/
-  static inline void replace_underscores(const char *input, char *output,
-                                         size_t output_size) {
-    if (input == NULL || output == NULL)
-      return;
-    memset(output, 0, output_size);
-    for (size_t i = 0; input[i] != '\0' && i < output_size - 1; i++) {
-      output[i] = (input[i] == '_') ? ' ' : input[i];
-    }
-    output[output_size - 1] = '\0';
+  static inline size_t replace_underscores(const char *input, char *output,
+                                           size_t output_size) {
+    return bulkTransform(input, output, output_size, '_', ' ', false);
   }
 
   /**
    * *******************************************************************
    * @brief   helper function to replace whitespace with underscore
+   *          input and output may be the same buffer
    * @param   input string
    * @param   output string
    * @param   output_size
-   * @return  none
+   * @return  length written (without '\0')
+   * *******************************************************************/
+  static inline size_t replace_whitespace(const char *input, char *output,
+                                          size_t output_size) {
+    return bulkTransform(input, output, output_size, ' ', '_', false);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   helper function to replace a character
+   *          input and output may be the same buffer
+   * @param   input string
+   * @param   output string
+   * @param   output_size
+   * @param   from  character to replace
+   * @param   to    replacement character
+   * @return  length written (without '\0')
+   * *******************************************************************/
+  static inline size_t replace_char(const char *input, char *output,
+                                    size_t output_size, char from, char to) {
+    return bulkTransform(input, output, output_size, (uint8_t)from, (uint8_t)to, false);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   helper function to lower string input (ASCII)
+   *          input and output may be the same buffer
+   * @param   input string
+   * @param   output string
+   * @param   output_size
+   * @return  length written (without '\0')
+   * *******************************************************************/
+  static inline size_t to_lowercase(const char *input, char *output,
+                                    size_t output_size) {
+    return bulkTransform(input, output, output_size, 'A', 'Z', true);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   helper function to upper string input (ASCII)
+   *          input and output may be the same buffer
+   * @param   input string
+   * @param   output string
+   * @param   output_size
+   * @return  length written (without '\0')
+   * *******************************************************************/
+  static inline size_t to_uppercase(const char *input, char *output,
+                                    size_t output_size) {
+    return bulkTransform(input, output, output_size, 'a', 'z', true);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   map every character with a lookup table
+   *          input and output may be the same buffer
+   * @param   input string
+   * @param   output string
+   * @param   output_size
+   * @param   map   character map, chars mapped to '\0' are removed
+   * @return  length written (without '\0')
    * *******************************************************************/
-  static inline void replace_whitespace(const char *input, char *output,
-                                        size_t output_size) {
-    if (input == NULL || output == NULL)
-      return;
-    memset(output, 0, output_size);
-    for (size_t i = 0; input[i] != '\0' && i < output_size - 1; i++) {
-      output[i] = (input[i] == ' ') ? '_' : input[i];
+  static inline size_t transform(const char *input, char *output,
+                                 size_t output_size, const EspCharMap &map) {
+    ESP_STR_PROFILE(Transform, input ? strlen(input) : 0);
+    if (input == NULL || output == NULL || output_size == 0)
+      return 0;
+    size_t len = 0;
+    for (; *input != '\0'; input++) {
+      char c = map[(unsigned char)*input];
+      if (c == '\0')
+        continue;
+      if (len >= output_size - 1)
+        break;
+      output[len++] = c;
     }
-    output[output_size - 1] = '\0';
+    output[len] = '\0';
+    return len;
   }
 
   /**
    * *******************************************************************
-   * @brief   helper function to lower string input
+   * @brief   remove characters from string
+   *          input and output may be the same buffer
    * @param   input string
    * @param   output string
    * @param   output_size
-   * @return  none
+   * @param   chars characters to remove, e.g. " \t"
+   * @return  length written (without '\0')
    * *******************************************************************/
-  static inline void to_lowercase(const char *input, char *output,
-                                  size_t output_size) {
-    if (input == NULL || output == NULL)
-      return;
-    memset(output, 0, output_size);
-    size_t i;
-    for (i = 0; input[i] != '\0' && i < output_size - 1; i++) {
-      output[i] = tolower((unsigned char)input[i]);
+  static inline size_t strip_chars(const char *input, char *output,
+                                   size_t output_size, const char *chars) {
+    EspCharMap map;
+    map.drop(chars);
+    return transform(input, output, output_size, map);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   convert name into an entity id like Home Assistant does:
+   *          lowercase a-z and 0-9, everything else becomes a single '_',
+   *          no leading or trailing '_' ("Boiler Temp. (°C)" -> "boiler_temp_c")
+   *          input and output may be the same buffer
+   * @param   input string
+   * @param   output string
+   * @param   output_size
+   * @return  length written (without '\0')
+   * *******************************************************************/
+  static inline size_t slugify(const char *input, char *output,
+                               size_t output_size) {
+    ESP_STR_PROFILE(Transform, input ? strlen(input) : 0);
+    static constexpr EspCharMap map = []() {
+      EspCharMap m;
+      for (int c = 1; c < 256; c++) {
+        bool alnum = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        if (!alnum)
+          m.set((char)c, '_');
+      }
+      return m.lower();
+    }();
+    if (input == NULL || output == NULL || output_size == 0)
+      return 0;
+    size_t len = 0;
+    bool separator = false;
+    for (; *input != '\0'; input++) {
+      char c = map[(unsigned char)*input];
+      if (c == '_') {
+        separator = len > 0; // collapse runs, no leading '_'
+        continue;
+      }
+      if (len + separator >= output_size - 1)
+        break;
+      if (separator)
+        output[len++] = '_';
+      output[len++] = c;
+      separator = false;
     }
-    output[i] = '\0';
+    output[len] = '\0';
+    return len;
   }
 
   /**
    * *******************************************************************
    * @brief   helper function to check if string is a number
    * @param   input string
-   * @return  true if string is a number
+   * @return  true if string is a (decimal integer) number
    * *******************************************************************/
   static inline bool isNumber(const char *str) {
-    int num;
-    char end;
-    if (sscanf(str, "%d%c", &num, &end) == 1) {
-      return true; // string is not a number
+    return str != NULL && isNumber(str, strlen(str));
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   check if string with length is a decimal integer number,
+   *          leading whitespace and sign are allowed
+   * @param   str string, does not need to be null terminated
+   * @param   len length of string
+   * @return  true if string is a number
+   * *******************************************************************/
+  static inline bool isNumber(const char *str, size_t len) {
+    ESP_STR_PROFILE(Parse, len);
+    size_t i = 0;
+    while (i < len && isspace((unsigned char)str[i]))
+      i++;
+    if (i < len && (str[i] == '-' || str[i] == '+'))
+      i++;
+    size_t digits = i;
+    while (i < len && (unsigned char)(str[i] - '0') < 10)
+      i++;
+    return i > digits && i == len;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   parse integer (like std::from_chars, single pass)
+   *          optional sign, no whitespace, base 16 also accepts "0x"
+   * @param   first  begin of input
+   * @param   last   end of input
+   * @param   value  result, only changed if successful
+   * @param   base   2..36, 0 = decimal or hex with "0x" prefix
+   * @return  result with end pointer and error code
+   * *******************************************************************/
+  template <typename T>
+  static inline EspParseResult parseInt(const char *first, const char *last, T &value, int base = 10) {
+    static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "parseInt requires an integer type");
+    ESP_STR_PROFILE(Parse, first && last > first ? last - first : 0);
+    typedef typename std::make_unsigned<T>::type U;
+    const char *p = first;
+    if (first == NULL || last == NULL || base == 1 || base < 0 || base > 36)
+      return {first, EspParseError::Invalid};
+    bool negative = false;
+    if (p < last && (*p == '-' || *p == '+')) {
+      negative = *p == '-';
+      p++;
+    }
+    if ((base == 0 || base == 16) && last - p > 2 && p[0] == '0' && (p[1] | 0x20) == 'x' && digitValue(p[2]) < 16) {
+      p += 2;
+      base = 16;
+    } else if (base == 0) {
+      base = 10;
+    }
+    if (negative && !std::is_signed<T>::value)
+      return {first, EspParseError::Invalid};
+    U limit = negative ? (U)((U)std::numeric_limits<T>::max() + 1) : (U)std::numeric_limits<T>::max();
+    U result = 0;
+    bool overflow = false;
+    const char *digits = p;
+    for (; p < last; p++) {
+      uint8_t digit = digitValue(*p);
+      if (digit >= base)
+        break;
+      if (result > (U)((limit - digit) / (U)base)) {
+        overflow = true; // continue to find the end of the number
+        continue;
+      }
+      result = (U)(result * base + digit);
+    }
+    if (p == digits)
+      return {first, EspParseError::Invalid};
+    if (overflow)
+      return {p, EspParseError::Overflow};
+    value = negative ? (T)(U(0) - result) : (T)result;
+    return {p, EspParseError::Ok};
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   parse complete string as integer, e.g. MQTT payload
+   * @param   str    null terminated input
+   * @param   value  result, only changed if successful
+   * @param   base   2..36, 0 = decimal or hex with "0x" prefix
+   * @return  true if the complete string is a number in range of T
+   * *******************************************************************/
+  template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+  static inline bool parseInt(const char *str, T &value, int base = 10) {
+    if (str == NULL)
+      return false;
+    const char *last = str + strlen(str);
+    EspParseResult r = parseInt(str, last, value, base);
+    return r && r.ptr == last;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   parse decimal number "-12.345" or "1.5e3" (single pass,
+   *          up to 15 digits and 22 decimals are converted exactly)
+   *          optional sign, no whitespace, no hex, nan or inf
+   * @param   first  begin of input
+   * @param   last   end of input
+   * @param   value  result (float or double), only changed if successful
+   * @return  result with end pointer and error code
+   * *******************************************************************/
+  template <typename T>
+  static inline EspParseResult parseFloat(const char *first, const char *last, T &value) {
+    static_assert(std::is_floating_point<T>::value, "parseFloat requires a float type");
+    ESP_STR_PROFILE(Parse, first && last > first ? last - first : 0);
+    if (first == NULL || last == NULL)
+      return {first, EspParseError::Invalid};
+    const char *p = first;
+    bool negative = false;
+    if (p < last && (*p == '-' || *p == '+')) {
+      negative = *p == '-';
+      p++;
+    }
+    uint64_t mantissa = 0;
+    int significant = 0; // digits in mantissa
+    int exponent = 0;    // decimal exponent of mantissa
+    int digits = 0;
+    for (; p < last && (unsigned char)(*p - '0') < 10; p++, digits++) {
+      if (significant < 19) {
+        mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        significant += mantissa != 0;
+      } else {
+        exponent++; // more digits than precision
+      }
+    }
+    if (p < last && *p == '.') {
+      const char *frac = ++p;
+      for (; p < last && (unsigned char)(*p - '0') < 10; p++) {
+        if (significant < 19) {
+          mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+          significant += mantissa != 0;
+          exponent--;
+        }
+      }
+      digits += (int)(p - frac);
+    }
+    if (digits == 0)
+      return {first, EspParseError::Invalid};
+    if (p < last && (*p | 0x20) == 'e') {
+      int expValue = 0;
+      const char *expStart = p + 1;
+      if (expStart < last && (*expStart == '+' || *expStart == '-'))
+        expStart++;
+      if (expStart < last && (unsigned char)(*expStart - '0') < 10) { // otherwise "e" is not part of the number
+        EspParseResult r = parseInt(p + 1, last, expValue);
+        if (!r)
+          expValue = p[1] == '-' ? -9999 : 9999; // far out of range
+        exponent += expValue;
+        p = r.ptr;
+      }
+    }
+
+    double result = (double)mantissa;
+    if (mantissa == 0) {
+      result = 0.0;
+    } else if (mantissa < (1ull << 53) && exponent >= -MAX_FAST_POW10 && exponent <= MAX_FAST_POW10) {
+      // exact: both operands are exact doubles, one rounding step
+      static const double pow10[MAX_FAST_POW10 + 1] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                                       1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                                       1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+      result = exponent < 0 ? result / pow10[-exponent] : result * pow10[exponent];
     } else {
-      return false; // string is a number
+      // rare: many digits or large exponent, let the C library round
+      char tmp[48];
+      size_t n = (size_t)(p - first);
+      if (n < sizeof(tmp)) {
+        memcpy(tmp, first, n);
+        tmp[n] = '\0';
+        result = fabs(strtod(tmp, NULL));
+      } else {
+        result = (double)mantissa * pow(10.0, exponent);
+      }
+    }
+    if (std::isinf((T)result))
+      return {p, EspParseError::Overflow};
+    value = (T)(negative ? -result : result);
+    return {p, EspParseError::Ok};
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   parse complete string as float or double
+   * @param   str    null terminated input
+   * @param   value  result, only changed if successful
+   * @return  true if the complete string is a number in range of T
+   * *******************************************************************/
+  template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+  static inline bool parseFloat(const char *str, T &value) {
+    if (str == NULL)
+      return false;
+    const char *last = str + strlen(str);
+    EspParseResult r = parseFloat(str, last, value);
+    return r && r.ptr == last;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   parse bool, complete input must be one of (case-insensitive)
+   *          "true", "on", "yes", "1" or "false", "off", "no", "0"
+   * @param   first  begin of input
+   * @param   last   end of input
+   * @param   value  result, only changed if successful
+   * @return  result with end pointer and error code
+   * *******************************************************************/
+  static inline EspParseResult parseBool(const char *first, const char *last, bool &value) {
+    ESP_STR_PROFILE(Parse, first && last > first ? last - first : 0);
+    static const char *const trueWords[] = {"true", "on", "yes", "1"};
+    static const char *const falseWords[] = {"false", "off", "no", "0"};
+    if (first == NULL || last == NULL || last <= first)
+      return {first, EspParseError::Invalid};
+    size_t len = (size_t)(last - first);
+    for (size_t i = 0; i < sizeof(trueWords) / sizeof(trueWords[0]); i++) {
+      if (equalsIgnoreCase(first, len, trueWords[i])) {
+        value = true;
+        return {last, EspParseError::Ok};
+      }
+      if (equalsIgnoreCase(first, len, falseWords[i])) {
+        value = false;
+        return {last, EspParseError::Ok};
+      }
     }
+    return {first, EspParseError::Invalid};
+  }
+
+  static inline bool parseBool(const char *str, bool &value) {
+    return str != NULL && parseBool(str, str + strlen(str), value);
   }
 
   /**
@@ -521,6 +2525,8 @@ public:
   /**
    * *******************************************************************
    * @brief   hash djb2 function
+   *          kept for compatibility, the result depends on the size of
+   *          unsigned long of the platform, use xxHash32() for new code
    * @param   str, len
    * @return  none
    * *******************************************************************/
@@ -534,24 +2540,133 @@ public:
     return hash;
   }
 
+  /**
+   * *******************************************************************
+   * @brief   format byte size with unit in caller buffer (integer only)
+   *          IEC: "512 B", "1.50 KiB", "3.20 MiB" ... up to EiB
+   *          SI:  "512 B", "1.54 kB", "3.36 MB" ... up to EB
+   * @param   buf       destination buffer
+   * @param   size      size of destination buffer (incl. '\0')
+   * @param   bytes     number of bytes
+   * @param   decimals  decimal places 0..6 (not used for "B")
+   * @param   si        false: steps of 1024 (IEC), true: steps of 1000 (SI)
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   * *******************************************************************/
+  static char *formatSize(char *buf, size_t size, uint64_t bytes, int decimals = 2, bool si = false) {
+    ESP_STR_PROFILE(Format, sizeof(bytes));
+    static const char *const iecUnits[] = {"B", "KiB", "MiB", "GiB", "TiB", "PiB", "EiB"};
+    static const char *const siUnits[] = {"B", "kB", "MB", "GB", "TB", "PB", "EB"};
+    int unit = 0;
+    uint64_t divisor = 1;
+    if (si) {
+      while (unit < 6 && bytes / divisor >= 1000) {
+        divisor *= 1000;
+        unit++;
+      }
+      return formatRatio(buf, size, bytes, 0, divisor, unit ? decimals : 0, siUnits[unit]);
+    }
+    while (unit < 6 && (bytes >> (unit * 10)) >= 1024)
+      unit++;
+    return formatRatio(buf, size, bytes, unit * 10, 1, unit ? decimals : 0, iecUnits[unit]);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   format duration in caller buffer, e.g. uptime
+   *          "04:12:07" or with days "3d 04:12:07"
+   * @param   buf      destination buffer
+   * @param   size     size of destination buffer (incl. '\0')
+   * @param   seconds  duration in seconds
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   * *******************************************************************/
+  static char *formatDuration(char *buf, size_t size, uint64_t seconds) {
+    ESP_STR_PROFILE(Format, sizeof(seconds));
+    uint64_t days = seconds / 86400;
+    uint32_t rest = (uint32_t)(seconds % 86400);
+    char tmp[MAX_INT_DIGITS + 11];
+    char *end = tmp + sizeof(tmp);
+    char *start = end - 8;
+    put2(start, rest / 3600);
+    start[2] = ':';
+    put2(start + 3, rest / 60 % 60);
+    start[5] = ':';
+    put2(start + 6, rest % 60);
+    if (days > 0) {
+      *--start = ' ';
+      *--start = 'd';
+      start = writeUnsigned64(start, days);
+    }
+    return copyOut(buf, size, start, end);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   format rate in caller buffer (integer only), scaled with
+   *          SI prefix: "850.0 msg/s", "1.5 kB/s", "12.3 Mbit/s"
+   * @param   buf       destination buffer
+   * @param   size      size of destination buffer (incl. '\0')
+   * @param   count     number of events or bytes in the period
+   * @param   periodMs  length of the period in ms
+   * @param   unit      unit of count, e.g. "B" or "msg"
+   * @param   decimals  decimal places 0..3
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   *          or period is 0
+   * *******************************************************************/
+  static char *formatRate(char *buf, size_t size, uint64_t count, uint32_t periodMs, const char *unit = "B",
+                          int decimals = 1) {
+    ESP_STR_PROFILE(Format, sizeof(count));
+    static const char *const prefixes[] = {"", "k", "M", "G", "T"};
+    if (periodMs == 0)
+      return NULL;
+    if (decimals > 3)
+      decimals = 3;
+    uint64_t quotient = count / periodMs;
+    uint64_t remainder = count % periodMs;
+    uint64_t rate;
+    int prefix = 0;
+    uint64_t divisor = 1000;
+    if (quotient <= (UINT64_MAX - 1000000) / 1000000) {
+      // rate in 1/1000 per second, rounded
+      rate = quotient * 1000000 + (remainder * 1000000 + periodMs / 2) / periodMs;
+      while (prefix < 4 && rate / divisor >= 1000) {
+        divisor *= 1000;
+        prefix++;
+      }
+    } else {
+      // 1/1000 per second would overflow, rate >= 1.8e16/s is always "T":
+      // count per ms is the rate in 1000 per second, rounded
+      rate = quotient + (remainder * 2 >= periodMs);
+      prefix = 4;
+      divisor = 1000000000;
+    }
+    char scaledUnit[24];
+    char *p = scaledUnit;
+    size_t prefixLen = strlen(prefixes[prefix]);
+    size_t unitLen = unit ? strlen(unit) : 0;
+    if (prefixLen + unitLen >= sizeof(scaledUnit))
+      return NULL;
+    memcpy(p, prefixes[prefix], prefixLen);
+    if (unitLen)
+      memcpy(p + prefixLen, unit, unitLen);
+    p[prefixLen + unitLen] = '\0';
+    return formatRatio(buf, size, rate, 0, divisor, decimals, scaledUnit, "/s");
+  }
+
   /**
    * *******************************************************************
    * @brief   convert Bytes to fromatted string
+   *          uses steps of 1024, see formatSize() for a caller buffer
    * @param   bytes
    * @return  formatted string (Bytes, kBytes, MB, GB)
    * *******************************************************************/
   static inline const char *formatBytes(unsigned long long bytes) {
-    const char *units[] = {"Byte", "kB", "MB", "GB"};
-    static char formatted[20];
-    double value = bytes;
+    ESP_STR_PROFILE(Format, sizeof(bytes));
+    static const char *const units[] = {"Byte", "kB", "MB", "GB"};
+    ESP_STR_RESULT(formatted, 24);
     int unitIndex = 0;
-
-    while (value >= 1024 && unitIndex < 3) {
-      value /= 1024.0;
+    while (unitIndex < 3 && (bytes >> (unitIndex * 10)) >= 1024)
       unitIndex++;
-    }
-
-    snprintf(formatted, sizeof(formatted), "%.2f %s", value, units[unitIndex]);
+    formatRatio(formatted, 24, bytes, unitIndex * 10, 1, 2, units[unitIndex]);
     return formatted;
   }
 };
\ No newline at end of file
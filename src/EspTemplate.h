@@ -0,0 +1,270 @@
+#pragma once
+
+#include "EspStrBuilder.h"
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   placeholder found by EspTemplate::compile()
+ * *******************************************************************/
+struct EspTemplateToken {
+  EspStrView name; // name without delimiters, len 0 for "%%"
+  uint32_t hash;   // EspStrUtil::xxHash32() of name, same as EspStrUtil::hash32("NAME")
+  uint32_t offset; // offset of the first delimiter in the template
+  uint32_t length; // length incl. delimiters
+};
+
+/**
+ * *******************************************************************
+ * @brief   callback that supplies the value of a placeholder
+ * @param   token        placeholder, e.g. switch (token.hash) { case EspStrUtil::hash32("TEMP"): ...
+ * @param   scratch      buffer that can be used to format the value
+ * @param   scratchSize  size of scratch buffer
+ * @param   ctx          user context pointer passed to render()
+ * @return  value (not null terminated), {NULL, 0} keeps the placeholder as it is
+ * *******************************************************************/
+typedef EspStrView (*EspTemplateResolver)(const EspTemplateToken &token, char *scratch, size_t scratchSize, void *ctx);
+
+/**
+ * *******************************************************************
+ * @brief   precompiled template with %PLACEHOLDER% tokens
+ *          compile() finds all placeholders once (names of A-Z, a-z,
+ *          0-9 and '_', "%%" is written as '%'), render() streams the
+ *          text between them directly from the template (also in flash)
+ *          and asks the resolver only for the values, without any
+ *          rescan or copy of the template.
+ *
+ *          static EspTemplate<16> page;
+ *          page.compile(PAGE_HTML);
+ *          page.render(resolver, NULL, sendChunk, client);
+ * *******************************************************************/
+template <size_t MAX_TOKENS>
+class EspTemplate {
+
+private:
+  static constexpr size_t SCRATCH_SIZE = 64;
+
+  const char *text = NULL;
+  size_t textLen = 0;
+  EspTemplateToken tokens[MAX_TOKENS];
+  size_t count = 0;
+  char delimiter = '%';
+
+  static bool isNameChar(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+  }
+
+public:
+  EspTemplate() = default;
+  EspTemplate(const EspTemplate &) = delete;
+  EspTemplate &operator=(const EspTemplate &) = delete;
+
+  /**
+   * *******************************************************************
+   * @brief   find all placeholders of a template
+   * @param   tpl        template, must stay valid while it is used
+   * @param   len        length of template
+   * @param   delimiter  placeholder delimiter
+   * @return  true if successful, false if there are more than
+   *          MAX_TOKENS placeholders
+   * *******************************************************************/
+  bool compile(const char *tpl, size_t len, char delimiter = '%') {
+    text = tpl;
+    textLen = tpl ? len : 0;
+    count = 0;
+    this->delimiter = delimiter;
+    const char *end = text + textLen;
+    const char *p = text;
+    while (p < end) {
+      const char *open = (const char *)memchr(p, delimiter, end - p);
+      if (open == NULL)
+        break;
+      const char *close = (const char *)memchr(open + 1, delimiter, end - open - 1);
+      if (close == NULL)
+        break;
+      const char *name = open + 1;
+      while (name < close && isNameChar(*name))
+        name++;
+      if (name != close) {
+        p = close; // no placeholder, the closing delimiter may open the next one
+        continue;
+      }
+      if (count >= MAX_TOKENS) {
+        count = 0;
+        text = NULL;
+        textLen = 0;
+        return false;
+      }
+      EspTemplateToken &t = tokens[count++];
+      t.name = {open + 1, (size_t)(close - open - 1)};
+      t.hash = EspStrUtil::xxHash32(t.name.data, t.name.len);
+      t.offset = (uint32_t)(open - text);
+      t.length = (uint32_t)(close - open + 1);
+      p = close + 1;
+    }
+    return true;
+  }
+
+  bool compile(const char *tpl, char delimiter = '%') { return compile(tpl, tpl ? strlen(tpl) : 0, delimiter); }
+
+  /**
+   * *******************************************************************
+   * @brief   render the template to a sink
+   * @param   resolver  callback that supplies the placeholder values
+   * @param   ctx       user context pointer passed to the resolver
+   * @param   sink      callback that receives the output in chunks
+   * @param   sinkCtx   user context pointer passed to the sink
+   * @return  true if successful, false if the sink aborted
+   * *******************************************************************/
+  bool render(EspTemplateResolver resolver, void *ctx, EspStreamSink sink, void *sinkCtx = NULL) const {
+    if (sink == NULL)
+      return false;
+    char scratch[SCRATCH_SIZE];
+    size_t pos = 0;
+    for (size_t i = 0; i < count; i++) {
+      const EspTemplateToken &t = tokens[i];
+      if (t.offset > pos && !sink(text + pos, t.offset - pos, sinkCtx))
+        return false;
+      pos = t.offset + t.length;
+      EspStrView value = {&delimiter, 1}; // "%%"
+      if (t.name.len > 0) {
+        value = resolver ? resolver(t, scratch, sizeof(scratch), ctx) : EspStrView{NULL, 0};
+        if (value.data == NULL)
+          value = {text + t.offset, t.length}; // unknown, keep the placeholder
+      }
+      if (value.len > 0 && !sink(value.data, value.len, sinkCtx))
+        return false;
+    }
+    return pos >= textLen || sink(text + pos, textLen - pos, sinkCtx);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   render the template into a buffer
+   * @param   buf       destination buffer
+   * @param   size      size of destination buffer (incl. '\0')
+   * @param   resolver  callback that supplies the placeholder values
+   * @param   ctx       user context pointer passed to the resolver
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   * *******************************************************************/
+  char *render(char *buf, size_t size, EspTemplateResolver resolver, void *ctx = NULL) const {
+    if (buf == NULL || size == 0)
+      return NULL;
+    EspStrSpan out(buf, size);
+    bool ok = render(resolver, ctx, EspStrSpan::sink, &out);
+    return ok && !out.overflow() ? buf + out.length() : NULL;
+  }
+
+  size_t size() const { return count; }
+  const EspTemplateToken &token(size_t i) const { return tokens[i]; }
+};
+
+/**
+ * *******************************************************************
+ * @brief   replace several substrings in one pass
+ *          scans the input once, a 256-bit table of the first chars of
+ *          all patterns rejects most positions with a single lookup.
+ *          At every position the longest matching pattern wins.
+ *
+ *          EspReplacer<3> html;
+ *          html.add("&", "&amp;").add("<", "&lt;").add(">", "&gt;");
+ *          html.replace(input, output, sizeof(output));
+ * *******************************************************************/
+template <size_t MAX_PATTERNS>
+class EspReplacer {
+
+private:
+  EspStrView from[MAX_PATTERNS];
+  EspStrView to[MAX_PATTERNS];
+  uint32_t firstChars[8] = {}; // bitset of the first chars of all patterns
+  size_t count = 0;
+  bool error = false;
+
+  // index of the longest pattern at p or -1
+  int match(const char *p, const char *end) const {
+    unsigned char c = (unsigned char)*p;
+    if ((firstChars[c >> 5] & (1u << (c & 31))) == 0)
+      return -1;
+    int best = -1;
+    for (size_t i = 0; i < count; i++) {
+      if (from[i].len <= (size_t)(end - p) && (best < 0 || from[i].len > from[best].len) &&
+          memcmp(p, from[i].data, from[i].len) == 0)
+        best = (int)i;
+    }
+    return best;
+  }
+
+public:
+  EspReplacer() = default;
+  EspReplacer(const EspReplacer &) = delete;
+  EspReplacer &operator=(const EspReplacer &) = delete;
+
+  /**
+   * *******************************************************************
+   * @brief   add a pattern, the strings must stay valid
+   * @param   pattern      string to search (not empty)
+   * @param   replacement  replacement string
+   * @return  reference to this replacer, see ok()
+   * *******************************************************************/
+  EspReplacer &add(const char *pattern, const char *replacement) {
+    if (pattern == NULL || *pattern == '\0' || count >= MAX_PATTERNS) {
+      error = true;
+      return *this;
+    }
+    from[count] = {pattern, strlen(pattern)};
+    to[count] = {replacement ? replacement : "", replacement ? strlen(replacement) : 0};
+    unsigned char c = (unsigned char)pattern[0];
+    firstChars[c >> 5] |= 1u << (c & 31);
+    count++;
+    return *this;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   replace all patterns and write the result to a sink
+   * @param   input    input string (may be not null terminated)
+   * @param   len      length of input
+   * @param   sink     callback that receives the output in chunks
+   * @param   sinkCtx  user context pointer passed to the sink
+   * @return  true if successful, false if the sink aborted
+   * *******************************************************************/
+  bool replace(const char *input, size_t len, EspStreamSink sink, void *sinkCtx = NULL) const {
+    if (sink == NULL || (input == NULL && len > 0))
+      return false;
+    const char *end = input + len;
+    const char *start = input; // begin of the pending unchanged text
+    for (const char *p = input; p < end;) {
+      int i = match(p, end);
+      if (i < 0) {
+        p++;
+        continue;
+      }
+      if (p > start && !sink(start, p - start, sinkCtx))
+        return false;
+      if (to[i].len > 0 && !sink(to[i].data, to[i].len, sinkCtx))
+        return false;
+      p += from[i].len;
+      start = p;
+    }
+    return end <= start || sink(start, end - start, sinkCtx);
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   replace all patterns and write the result into a buffer
+   * @param   input   null terminated input string
+   * @param   output  destination buffer (not the input buffer)
+   * @param   size    size of destination buffer (incl. '\0')
+   * @return  pointer to the terminating '\0' or NULL if buffer to small
+   * *******************************************************************/
+  char *replace(const char *input, char *output, size_t size) const {
+    if (input == NULL || output == NULL || size == 0)
+      return NULL;
+    EspStrSpan out(output, size);
+    bool ok = replace(input, strlen(input), EspStrSpan::sink, &out);
+    return ok && !out.overflow() ? output + out.length() : NULL;
+  }
+
+  bool ok() const { return !error; }
+  size_t size() const { return count; }
+};
@@ -0,0 +1,545 @@
+#pragma once
+
+#include "EspStrUtil.h"
+
+/**
+ * *******************************************************************
+ * @brief   current token of EspJsonReader / EspKvReader
+ *          the text is a view into the input buffer (zero-copy),
+ *          JSON strings are without quotes and escapes are not decoded.
+ * *******************************************************************/
+class EspTextToken {
+
+protected:
+  EspStrView tok = {NULL, 0};
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   raw text of the current token
+   * @return  view into the input buffer
+   * *******************************************************************/
+  EspStrView text() const { return tok; }
+
+  /**
+   * *******************************************************************
+   * @brief   compare the current token with a string
+   * @param   str  null terminated string
+   * @return  true if equal
+   * *******************************************************************/
+  bool equals(const char *str) const {
+    return str != NULL && strlen(str) == tok.len && memcmp(str, tok.data, tok.len) == 0;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   get token as integer (see EspStrUtil::parseInt)
+   * @param   out   result, only changed if successful
+   * @param   base  2..36, 0 = decimal or hex with "0x" prefix
+   * @return  true if the complete token is an integer that fits into T
+   * *******************************************************************/
+  template <typename T>
+  bool asInt(T &out, int base = 10) const {
+    EspParseResult r = EspStrUtil::parseInt(tok.data, tok.data + tok.len, out, base);
+    return r && r.ptr == tok.data + tok.len;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   get token as float or double (see EspStrUtil::parseFloat)
+   * @param   out  result, only changed if successful
+   * @return  true if the complete token is a number
+   * *******************************************************************/
+  template <typename T>
+  bool asFloat(T &out) const {
+    EspParseResult r = EspStrUtil::parseFloat(tok.data, tok.data + tok.len, out);
+    return r && r.ptr == tok.data + tok.len;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   get token as bool (see EspStrUtil::stringToBool)
+   * @return  true for "true", "1", "on" or "yes"
+   * *******************************************************************/
+  bool asBool() const { return EspStrUtil::stringToBool(tok.data, tok.len); }
+
+  /**
+   * *******************************************************************
+   * @brief   get token as bool (see EspStrUtil::parseBool)
+   * @param   out  result, only changed if successful
+   * @return  true if the token is a valid bool word
+   * *******************************************************************/
+  bool asBool(bool &out) const { return (bool)EspStrUtil::parseBool(tok.data, tok.data + tok.len, out); }
+
+  /**
+   * *******************************************************************
+   * @brief   copy token into a buffer and decode JSON escapes
+   * @param   dst   destination buffer
+   * @param   size  size of destination buffer (incl. '\0')
+   * @return  true if successful, false if buffer to small
+   * *******************************************************************/
+  bool copyTo(char *dst, size_t size) const {
+    if (dst == NULL || size == 0)
+      return false;
+    size_t n = 0;
+    for (size_t i = 0; i < tok.len; i++) {
+      char c = tok.data[i];
+      if (c == '\\' && i + 1 < tok.len) {
+        c = tok.data[++i];
+        switch (c) {
+        case 'b':
+          c = '\b';
+          break;
+        case 'f':
+          c = '\f';
+          break;
+        case 'n':
+          c = '\n';
+          break;
+        case 'r':
+          c = '\r';
+          break;
+        case 't':
+          c = '\t';
+          break;
+        case 'u': {
+          uint32_t cp = 0;
+          if (!hex4(i + 1, cp))
+            return false;
+          i += 4;
+          // UTF-16 surrogate pair
+          uint32_t low = 0;
+          if (cp >= 0xD800 && cp < 0xDC00 && i + 6 < tok.len && tok.data[i + 1] == '\\' && tok.data[i + 2] == 'u' && hex4(i + 3, low) &&
+              low >= 0xDC00 && low < 0xE000) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            i += 6;
+          }
+          char utf8[4];
+          size_t utf8Len = encodeUtf8(cp, utf8);
+          if (n + utf8Len >= size)
+            return false;
+          memcpy(dst + n, utf8, utf8Len);
+          n += utf8Len;
+          continue;
+        }
+        default:
+          break; // '"', '\\', '/' and unknown escapes: take char as it is
+        }
+      }
+      if (n + 1 >= size)
+        return false;
+      dst[n++] = c;
+    }
+    dst[n] = '\0';
+    return true;
+  }
+
+private:
+  bool hex4(size_t pos, uint32_t &out) const {
+    if (pos + 4 > tok.len)
+      return false;
+    out = 0;
+    for (size_t i = pos; i < pos + 4; i++) {
+      char c = tok.data[i];
+      uint32_t v;
+      if (c >= '0' && c <= '9')
+        v = c - '0';
+      else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+        v = (c | 0x20) - 'a' + 10;
+      else
+        return false;
+      out = (out << 4) | v;
+    }
+    return true;
+  }
+
+  static size_t encodeUtf8(uint32_t cp, char *out) {
+    if (cp < 0x80) {
+      out[0] = (char)cp;
+      return 1;
+    }
+    if (cp < 0x800) {
+      out[0] = (char)(0xC0 | (cp >> 6));
+      out[1] = (char)(0x80 | (cp & 0x3F));
+      return 2;
+    }
+    if (cp < 0x10000) {
+      out[0] = (char)(0xE0 | (cp >> 12));
+      out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+      out[2] = (char)(0x80 | (cp & 0x3F));
+      return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+  }
+};
+
+/**
+ * *******************************************************************
+ * @brief   token types of EspJsonReader
+ * *******************************************************************/
+enum class EspJsonToken : uint8_t {
+  BeginObject,
+  EndObject,
+  BeginArray,
+  EndArray,
+  Key,
+  String,
+  Number,
+  True,
+  False,
+  Null,
+  End,  // complete document was read
+  Error // syntax error, see EspJsonReader::errorOffset()
+};
+
+/**
+ * *******************************************************************
+ * @brief   zero-copy JSON pull parser
+ *          reads the input buffer in place token by token, nothing is
+ *          copied or allocated.
+ *
+ *          EspJsonReader json(buf, len);
+ *          if (json.next() == EspJsonToken::BeginObject) {
+ *            while (json.next() == EspJsonToken::Key) {
+ *              if (json.equals("port")) {
+ *                json.next();
+ *                json.asInt(config.port);
+ *              } else {
+ *                json.skip();
+ *              }
+ *            }
+ *          }
+ * *******************************************************************/
+class EspJsonReader : public EspTextToken {
+
+private:
+  static constexpr int MAX_DEPTH = 32;
+
+  enum Expect : uint8_t { EXPECT_VALUE, EXPECT_KEY, EXPECT_KEY_OR_CLOSE, EXPECT_VALUE_OR_CLOSE, EXPECT_COMMA_OR_CLOSE, EXPECT_END };
+
+  const char *start;
+  const char *p;
+  const char *end;
+  uint32_t isObject = 0; // bit per nesting level
+  int level = 0;
+  Expect expect = EXPECT_VALUE;
+  EspJsonToken current = EspJsonToken::End;
+
+  EspJsonToken fail() {
+    tok = {p, 0};
+    expect = EXPECT_END;
+    return current = EspJsonToken::Error;
+  }
+
+  void skipWhitespace() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+      p++;
+  }
+
+  // state after a complete value
+  void valueDone() { expect = level > 0 ? EXPECT_COMMA_OR_CLOSE : EXPECT_END; }
+
+  bool inObject() const { return level > 0 && (isObject & (1u << (level - 1))); }
+
+  EspJsonToken readString(EspJsonToken type) {
+    const char *s = ++p;
+    while (p < end && *p != '"') {
+      if ((unsigned char)*p < 0x20)
+        return fail(); // control chars are not allowed in strings
+      if (*p == '\\')
+        p++;
+      p++;
+    }
+    if (p >= end)
+      return fail();
+    tok = {s, (size_t)(p - s)};
+    p++;
+    return current = type;
+  }
+
+  EspJsonToken readLiteral(const char *word, size_t n, EspJsonToken type) {
+    if ((size_t)(end - p) < n || memcmp(p, word, n) != 0)
+      return fail();
+    tok = {p, n};
+    p += n;
+    valueDone();
+    return current = type;
+  }
+
+  bool isDigit() const { return p < end && (unsigned char)(*p - '0') < 10; }
+
+  void skipDigits() {
+    while (isDigit())
+      p++;
+  }
+
+  // JSON number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+  EspJsonToken readNumber() {
+    const char *s = p;
+    if (*p == '-')
+      p++;
+    if (!isDigit())
+      return fail();
+    if (*p++ != '0')
+      skipDigits(); // no leading zeros, "01" ends after the "0"
+    if (p < end && *p == '.') {
+      p++;
+      if (!isDigit())
+        return fail();
+      skipDigits();
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+      p++;
+      if (p < end && (*p == '+' || *p == '-'))
+        p++;
+      if (!isDigit())
+        return fail();
+      skipDigits();
+    }
+    tok = {s, (size_t)(p - s)};
+    valueDone();
+    return current = EspJsonToken::Number;
+  }
+
+  EspJsonToken readValue() {
+    char c = *p;
+    if (c == '{' || c == '[') {
+      if (level >= MAX_DEPTH)
+        return fail();
+      level++;
+      uint32_t bit = 1u << (level - 1);
+      tok = {p++, 1};
+      if (c == '{') {
+        isObject |= bit;
+        expect = EXPECT_KEY_OR_CLOSE;
+        return current = EspJsonToken::BeginObject;
+      }
+      isObject &= ~bit;
+      expect = EXPECT_VALUE_OR_CLOSE;
+      return current = EspJsonToken::BeginArray;
+    }
+    if (c == '"') {
+      EspJsonToken type = readString(EspJsonToken::String);
+      if (type != EspJsonToken::Error)
+        valueDone();
+      return type;
+    }
+    if (c == '-' || (c >= '0' && c <= '9'))
+      return readNumber();
+    if (c == 't')
+      return readLiteral("true", 4, EspJsonToken::True);
+    if (c == 'f')
+      return readLiteral("false", 5, EspJsonToken::False);
+    if (c == 'n')
+      return readLiteral("null", 4, EspJsonToken::Null);
+    return fail();
+  }
+
+  EspJsonToken close() {
+    bool object = *p == '}';
+    if (object != inObject())
+      return fail();
+    tok = {p++, 1};
+    level--;
+    valueDone();
+    return current = object ? EspJsonToken::EndObject : EspJsonToken::EndArray;
+  }
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   create reader on a JSON buffer (must stay valid)
+   * @param   json  JSON text, does not need to be null terminated
+   * @param   len   length of JSON text
+   * *******************************************************************/
+  EspJsonReader(const char *json, size_t len) : start(json), p(json), end(json + len) {}
+  explicit EspJsonReader(const char *json) : EspJsonReader(json, json ? strlen(json) : 0) {}
+
+  /**
+   * *******************************************************************
+   * @brief   read the next token
+   * @return  token type, the text is available with text()
+   * *******************************************************************/
+  EspJsonToken next() {
+    if (current == EspJsonToken::Error)
+      return current;
+    skipWhitespace();
+    if (p >= end) {
+      if (expect != EXPECT_END)
+        return fail(); // unexpected end
+      tok = {p, 0};
+      return current = EspJsonToken::End;
+    }
+
+    switch (expect) {
+    case EXPECT_END:
+      return fail(); // data after the document
+    case EXPECT_COMMA_OR_CLOSE:
+      if (*p == '}' || *p == ']')
+        return close();
+      if (*p != ',')
+        return fail();
+      p++;
+      skipWhitespace();
+      if (p >= end)
+        return fail();
+      if (!inObject())
+        return readValue();
+      // fall through
+    case EXPECT_KEY:
+    case EXPECT_KEY_OR_CLOSE:
+      if (expect == EXPECT_KEY_OR_CLOSE && *p == '}')
+        return close();
+      if (*p != '"' || readString(EspJsonToken::Key) == EspJsonToken::Error)
+        return fail();
+      skipWhitespace();
+      if (p >= end || *p != ':')
+        return fail();
+      p++;
+      expect = EXPECT_VALUE;
+      return current;
+    case EXPECT_VALUE_OR_CLOSE:
+      if (*p == ']')
+        return close();
+      return readValue();
+    case EXPECT_VALUE:
+    default:
+      return readValue();
+    }
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   skip the value after a key or the rest of the current
+   *          object/array if called after BeginObject/BeginArray
+   * @return  true if successful
+   * *******************************************************************/
+  bool skip() {
+    int target = level;
+    if (current == EspJsonToken::Key) {
+      EspJsonToken t = next();
+      if (t != EspJsonToken::BeginObject && t != EspJsonToken::BeginArray)
+        return t != EspJsonToken::Error;
+    } else if (current != EspJsonToken::BeginObject && current != EspJsonToken::BeginArray) {
+      return current != EspJsonToken::Error;
+    } else {
+      target = level - 1;
+    }
+    while (level > target) {
+      if (next() == EspJsonToken::Error)
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   search a key in the current object, skips other members
+   *          and stops after the key (next() reads its value)
+   * @param   key  key to search
+   * @return  true if the key was found
+   * *******************************************************************/
+  bool findKey(const char *key) {
+    int objectLevel = level;
+    while (true) {
+      EspJsonToken t = next();
+      if (t != EspJsonToken::Key || level != objectLevel)
+        return false;
+      if (equals(key))
+        return true;
+      if (!skip())
+        return false;
+    }
+  }
+
+  EspJsonToken token() const { return current; }
+  int depth() const { return level; }
+  size_t errorOffset() const { return p - start; }
+};
+
+/**
+ * *******************************************************************
+ * @brief   zero-copy reader for "key=value" config files
+ *          one entry per line, whitespace around key and value is
+ *          removed, values may be quoted, lines starting with '#' or
+ *          ';' and empty lines are skipped.
+ * *******************************************************************/
+class EspKvReader : public EspTextToken {
+
+private:
+  const char *p;
+  const char *end;
+  EspStrView keyView = {NULL, 0};
+  size_t lineNo = 0;
+
+  static EspStrView trim(const char *s, const char *e) {
+    while (s < e && (*s == ' ' || *s == '\t'))
+      s++;
+    while (e > s && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\r'))
+      e--;
+    return {s, (size_t)(e - s)};
+  }
+
+public:
+  /**
+   * *******************************************************************
+   * @brief   create reader on a config buffer (must stay valid)
+   * @param   text  config text, does not need to be null terminated
+   * @param   len   length of config text
+   * *******************************************************************/
+  EspKvReader(const char *text, size_t len) : p(text), end(text + len) {}
+  explicit EspKvReader(const char *text) : EspKvReader(text, text ? strlen(text) : 0) {}
+
+  /**
+   * *******************************************************************
+   * @brief   read the next entry, the value is the current token
+   * @return  true if an entry was found, false at the end
+   * *******************************************************************/
+  bool next() {
+    while (p < end) {
+      const char *line = p;
+      const char *lineEnd = (const char *)memchr(p, '\n', end - p);
+      if (lineEnd == NULL)
+        lineEnd = end;
+      p = lineEnd < end ? lineEnd + 1 : end;
+      lineNo++;
+
+      EspStrView content = trim(line, lineEnd);
+      if (content.len == 0 || content.data[0] == '#' || content.data[0] == ';')
+        continue;
+      const char *eq = (const char *)memchr(content.data, '=', content.len);
+      if (eq == NULL)
+        continue; // no entry
+      keyView = trim(content.data, eq);
+      tok = trim(eq + 1, content.data + content.len);
+      if (tok.len >= 2 && (tok.data[0] == '"' || tok.data[0] == '\'') && tok.data[tok.len - 1] == tok.data[0]) {
+        tok = {tok.data + 1, tok.len - 2};
+      }
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * *******************************************************************
+   * @brief   key of the current entry
+   * @return  view into the input buffer
+   * *******************************************************************/
+  EspStrView key() const { return keyView; }
+
+  /**
+   * *******************************************************************
+   * @brief   compare the key of the current entry
+   * @param   str  null terminated string
+   * @return  true if equal
+   * *******************************************************************/
+  bool keyEquals(const char *str) const {
+    return str != NULL && strlen(str) == keyView.len && memcmp(str, keyView.data, keyView.len) == 0;
+  }
+
+  size_t line() const { return lineNo; }
+};